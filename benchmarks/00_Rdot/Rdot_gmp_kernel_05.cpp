@@ -0,0 +1,97 @@
+#include <iostream>
+#include <chrono>
+#include <gmp.h>
+
+#if defined USE_ORIGINAL_GMPXX
+#include <gmpxx.h>
+#else
+#include "gmpxx_mkII.h"
+#if !defined ___GMPXX_STRICT_COMPATIBILITY___
+using namespace gmpxx;
+#endif
+#endif
+
+#include "Rdot.hpp"
+
+#define MFLOPS 1e+6
+
+gmp_randstate_t state;
+
+// unit strides only
+mpf_class _Rdot(int64_t n, mpf_class *dx, mpf_class *dy) {
+    int64_t i;
+
+    mpf_class temp;
+    temp = 0.0;
+    for (i = 0; i < n; i++) {
+        addmul(temp, dx[i], dy[i]);
+    }
+    return temp;
+}
+
+void init_mpf_vec(mpf_t *vec, int n, int prec) {
+    for (int i = 0; i < n; i++) {
+        mpf_init2(vec[i], prec);
+        mpf_urandomb(vec[i], state, prec);
+    }
+}
+
+void clear_mpf_vec(mpf_t *vec, int n) {
+    for (int i = 0; i < n; i++) {
+        mpf_clear(vec[i]);
+    }
+}
+
+int main(int argc, char **argv) {
+    gmp_randinit_default(state);
+    gmp_randseed_ui(state, 42);
+
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <vector size> <precision>" << std::endl;
+        return 1;
+    }
+
+    int N = std::atoi(argv[1]);
+    int prec = std::atoi(argv[2]);
+    mpf_set_default_prec(prec);
+
+    mpf_t *vec1 = new mpf_t[N];
+    mpf_t *vec2 = new mpf_t[N];
+    init_mpf_vec(vec1, N, prec);
+    init_mpf_vec(vec2, N, prec);
+
+    mpf_class *vec1_mpf_class = new mpf_class[N];
+    mpf_class *vec2_mpf_class = new mpf_class[N];
+    mpf_class _ans;
+
+    for (int i = 0; i < N; i++) {
+        vec1_mpf_class[i] = mpf_class(vec1[i]);
+        vec2_mpf_class[i] = mpf_class(vec2[i]);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    _ans = _Rdot(N, vec1_mpf_class, vec2_mpf_class);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    mpf_class ans = Rdot(N, vec1_mpf_class, 1, vec2_mpf_class, 1);
+
+    std::chrono::duration<double> elapsed_seconds = end - start;
+    std::cout << "Elapsed time: " << elapsed_seconds.count() << " s" << std::endl;
+    std::cout << "MFLOPS: " << (2.0 * double(N) - 1.0) / elapsed_seconds.count() / MFLOPS << std::endl;
+
+    mpf_class _tmp;
+    _tmp = abs(_ans - ans);
+    std::cout << "DIFF: ";
+    gmp_printf("%.4Fg ", _tmp.get_mpf_t());
+    if (_tmp < 1e-5)
+        std::cout << "OK" << std::endl;
+    else
+        std::cout << "NG" << std::endl;
+
+    clear_mpf_vec(vec1, N);
+    clear_mpf_vec(vec2, N);
+    delete[] vec1;
+    delete[] vec2;
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <chrono>
+#include <gmp.h>
+
+#include "gmpxx_mkII.h"
+#include "gmpxx_mkII_blas.h"
+#if !defined ___GMPXX_STRICT_COMPATIBILITY___
+using namespace gmpxx;
+#endif
+
+#include "Rdot.hpp"
+
+#if defined _OPENMP
+#include <omp.h>
+#endif
+
+#define MFLOPS 1e+6
+
+// blas::Rdot (mpf_add per term) vs. blas::Rdot_exact (exact accumulation, one rounding),
+// and whether each gives the same bits for 1, 2, ... threads
+int main(int argc, char **argv) {
+    gmp_randclass r(gmp_randinit_default);
+    r.seed(42);
+
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <vector size> <precision>" << std::endl;
+        return 1;
+    }
+
+    int64_t N = std::atoll(argv[1]);
+    int prec = std::atoi(argv[2]);
+    mpf_set_default_prec(prec);
+
+    mpf_class *x = new mpf_class[N];
+    mpf_class *y = new mpf_class[N];
+    for (int64_t i = 0; i < N; i++) {
+        x[i] = r.get_f(prec);
+        y[i] = r.get_f(prec);
+        if (i % 2)
+            x[i] = -x[i];
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    mpf_class dot = blas::Rdot(N, x, 1, y, 1);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed_rdot = end - start;
+
+    start = std::chrono::high_resolution_clock::now();
+    mpf_class dot_exact = blas::Rdot_exact(N, x, 1, y, 1, prec);
+    end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed_exact = end - start;
+
+    mpf_class ans = Rdot(N, x, 1, y, 1);
+
+    std::cout << "Rdot elapsed time: " << elapsed_rdot.count() << " s, MFLOPS: " << (2.0 * double(N) - 1.0) / elapsed_rdot.count() / MFLOPS << std::endl;
+    std::cout << "Rdot_exact elapsed time: " << elapsed_exact.count() << " s, MFLOPS: " << (2.0 * double(N) - 1.0) / elapsed_exact.count() / MFLOPS << std::endl;
+
+    mpf_class _tmp = abs(dot_exact - ans);
+    std::cout << "DIFF: ";
+    gmp_printf("%.4Fg ", _tmp.get_mpf_t());
+    std::cout << (_tmp < 1e-5 ? "OK" : "NG") << std::endl;
+
+    int max_threads = 1;
+#if defined _OPENMP
+    max_threads = omp_get_max_threads();
+    blas::defaults::parallel_threshold = 1;
+#endif
+    bool rdot_reproducible = true, exact_reproducible = true;
+    for (int threads = 1; threads <= max_threads; threads++) {
+#if defined _OPENMP
+        omp_set_num_threads(threads);
+#endif
+        mpf_class _dot = blas::Rdot(N, x, 1, y, 1);
+        mpf_class _dot_exact = blas::Rdot_exact(N, x, 1, y, 1, prec);
+        if (threads == 1) {
+            dot = _dot;
+            dot_exact = _dot_exact;
+        }
+        rdot_reproducible = rdot_reproducible && mpf_cmp(_dot.get_mpf_t(), dot.get_mpf_t()) == 0;
+        exact_reproducible = exact_reproducible && mpf_cmp(_dot_exact.get_mpf_t(), dot_exact.get_mpf_t()) == 0;
+    }
+    std::cout << "Bitwise identical for 1.." << max_threads << " threads: Rdot " << (rdot_reproducible ? "yes" : "no") << ", Rdot_exact " << (exact_reproducible ? "yes" : "no") << std::endl;
+
+    delete[] x;
+    delete[] y;
+
+    return 0;
+}
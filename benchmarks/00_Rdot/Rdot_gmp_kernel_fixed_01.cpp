@@ -0,0 +1,90 @@
+#include <iostream>
+#include <chrono>
+#include <gmp.h>
+
+#include "gmpxx_mkII.h"
+#if !defined ___GMPXX_STRICT_COMPATIBILITY___
+using namespace gmpxx;
+#endif
+
+#include "Rdot.hpp"
+
+#define MFLOPS 1e+6
+
+// Rdot on contiguous mpf_fixed<Bits> vectors (unit strides): the limbs of all elements are stored
+// contiguously and the products live on the stack, so the kernel does not allocate.
+template <mp_bitcnt_t Bits> mpf_fixed<Bits> _Rdot(int64_t n, const mpf_fixed<Bits> *dx, const mpf_fixed<Bits> *dy) {
+    mpf_fixed<Bits> temp = 0.0;
+    for (int64_t i = 0; i < n; i++) {
+        temp += dx[i] * dy[i];
+    }
+    return temp;
+}
+
+template <mp_bitcnt_t Bits> int run(int64_t N) {
+    gmp_randclass r(gmp_randinit_default);
+    r.seed(42);
+
+    mpf_class *vec1_mpf_class = new mpf_class[N];
+    mpf_class *vec2_mpf_class = new mpf_class[N];
+    mpf_fixed<Bits> *vec1 = new mpf_fixed<Bits>[N];
+    mpf_fixed<Bits> *vec2 = new mpf_fixed<Bits>[N];
+
+    for (int64_t i = 0; i < N; i++) {
+        vec1_mpf_class[i] = r.get_f(Bits);
+        vec2_mpf_class[i] = r.get_f(Bits);
+        vec1[i] = vec1_mpf_class[i];
+        vec2[i] = vec2_mpf_class[i];
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    mpf_fixed<Bits> _ans = _Rdot(N, vec1, vec2);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    mpf_class ans = Rdot(N, vec1_mpf_class, 1, vec2_mpf_class, 1);
+
+    std::chrono::duration<double> elapsed_seconds = end - start;
+    std::cout << "Elapsed time: " << elapsed_seconds.count() << " s" << std::endl;
+    std::cout << "MFLOPS: " << (2.0 * double(N) - 1.0) / elapsed_seconds.count() / MFLOPS << std::endl;
+
+    mpf_class _tmp;
+    _tmp = abs(mpf_class(_ans) - ans);
+    std::cout << "DIFF: ";
+    gmp_printf("%.4Fg ", _tmp.get_mpf_t());
+    if (_tmp < 1e-5)
+        std::cout << "OK" << std::endl;
+    else
+        std::cout << "NG" << std::endl;
+
+    delete[] vec1_mpf_class;
+    delete[] vec2_mpf_class;
+    delete[] vec1;
+    delete[] vec2;
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <vector size> <precision: 256, 512, 1024 or 2048>" << std::endl;
+        return 1;
+    }
+
+    int64_t N = std::atoll(argv[1]);
+    int prec = std::atoi(argv[2]);
+    mpf_set_default_prec(prec);
+
+    switch (prec) {
+    case 256:
+        return run<256>(N);
+    case 512:
+        return run<512>(N);
+    case 1024:
+        return run<1024>(N);
+    case 2048:
+        return run<2048>(N);
+    default:
+        std::cerr << "Unsupported precision " << prec << std::endl;
+        return 1;
+    }
+}
@@ -16,12 +16,22 @@ executables=(
     "Rdot_gmp_kernel_04_orig"
     "Rdot_gmp_kernel_04_mkII"
     "Rdot_gmp_kernel_04_mkIISR"
+    "Rdot_gmp_kernel_05_mkII"
+    "Rdot_gmp_kernel_05_mkIISR"
     "Rdot_gmp_kernel_openmp_01_orig"
     "Rdot_gmp_kernel_openmp_01_mkII"
     "Rdot_gmp_kernel_openmp_01_mkIISR"
     "Rdot_gmp_kernel_openmp_02_orig"
     "Rdot_gmp_kernel_openmp_02_mkII"
     "Rdot_gmp_kernel_openmp_02_mkIISR"
+    "Rdot_gmp_kernel_openmp_03_mkII"
+    "Rdot_gmp_kernel_openmp_03_mkIISR"
+    "Rdot_gmp_kernel_fixed_01_mkII"
+    "Rdot_gmp_kernel_01_mkIIET"
+    "Rdot_gmp_kernel_blas_01_mkII"
+    "Rdot_gmp_kernel_blas_01_mkIISR"
+    "Rdot_gmp_kernel_exact_01_mkII"
+    "Rdot_gmp_kernel_exact_01_mkIISR"
 )
 for exe in "${executables[@]}"; do
     COMMAND_LINE="/usr/bin/time ./$exe 100000000 512"
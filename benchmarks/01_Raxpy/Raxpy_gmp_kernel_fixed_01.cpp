@@ -0,0 +1,98 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+#include "gmpxx_mkII.h"
+#if !defined ___GMPXX_STRICT_COMPATIBILITY___
+using namespace gmpxx;
+#endif
+
+#include "Raxpy.hpp"
+
+#define MFLOPS 1e+6
+
+// Raxpy on contiguous mpf_fixed<Bits> vectors (unit strides); alpha * x[i] is a stack temporary
+template <mp_bitcnt_t Bits> void _Raxpy(int64_t n, const mpf_fixed<Bits> &alpha, const mpf_fixed<Bits> *x, mpf_fixed<Bits> *y) {
+    for (int64_t i = 0; i < n; ++i) {
+        y[i] += alpha * x[i]; // y[i] = y[i] + alpha * x[i]
+    }
+}
+
+template <mp_bitcnt_t Bits> int run(int64_t N) {
+    gmp_randclass r(gmp_randinit_default);
+    r.seed(42);
+
+    mpf_fixed<Bits> *x = new mpf_fixed<Bits>[N];
+    mpf_fixed<Bits> *y = new mpf_fixed<Bits>[N];
+    mpf_class *xx = new mpf_class[N];
+    mpf_class *yy = new mpf_class[N];
+    mpf_class alpha_ref = r.get_f(Bits);
+    mpf_fixed<Bits> alpha = alpha_ref;
+
+    for (int64_t i = 0; i < N; ++i) {
+        xx[i] = r.get_f(Bits);
+        yy[i] = r.get_f(Bits);
+        x[i] = xx[i];
+        y[i] = yy[i];
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    _Raxpy(N, alpha, x, y);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    Raxpy(N, alpha_ref, xx, 1, yy, 1);
+
+    std::chrono::duration<double> elapsed_seconds = end - start;
+    double mflops = (2.0 * double(N)) / (elapsed_seconds.count() * MFLOPS);
+
+    std::cout << "Elapsed time: " << elapsed_seconds.count() << " s" << std::endl;
+    std::cout << "MFLOPS: " << mflops << std::endl;
+
+    mpf_class l1_norm = 0;
+    for (int64_t i = 0; i < N; ++i) {
+        mpf_class diff = abs(mpf_class(y[i]) - yy[i]);
+        l1_norm += diff;
+    }
+
+    std::cout << "L1 Norm of difference: ";
+    gmp_printf("%.4Fg\n", l1_norm.get_mpf_t());
+
+    mpf_class threshold = 1e-5;
+    if (l1_norm < threshold) {
+        std::cout << "Result OK" << std::endl;
+    } else {
+        std::cout << "Result NG" << std::endl;
+    }
+
+    delete[] x;
+    delete[] y;
+    delete[] xx;
+    delete[] yy;
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <vector size> <precision: 256, 512, 1024 or 2048>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int64_t N = std::atoll(argv[1]);
+    int prec = std::atoi(argv[2]);
+    mpf_set_default_prec(prec);
+
+    switch (prec) {
+    case 256:
+        return run<256>(N);
+    case 512:
+        return run<512>(N);
+    case 1024:
+        return run<1024>(N);
+    case 2048:
+        return run<2048>(N);
+    default:
+        std::cerr << "Unsupported precision " << prec << std::endl;
+        return EXIT_FAILURE;
+    }
+}
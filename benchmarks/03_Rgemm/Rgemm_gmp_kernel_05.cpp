@@ -0,0 +1,140 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+#include "gmpxx_mkII.h"
+#if !defined ___GMPXX_STRICT_COMPATIBILITY___
+using namespace gmpxx;
+#endif
+
+#include "Rgemm.hpp"
+
+#define MFLOPS 1e+6
+
+// cf. https://netlib.org/lapack/lawnspdf/lawn41.pdf p.120
+double flops_gemm(int k_i, int m_i, int n_i) {
+    double adds, muls, flops;
+    double k, m, n;
+    m = (double)m_i;
+    n = (double)n_i;
+    k = (double)k_i;
+    muls = m * (k + 2) * n;
+    adds = m * k * n;
+    flops = muls + adds;
+    return flops;
+}
+
+// The kernels of Rgemm_gmp_kernel_01 and _02 written with assignments from temporaries.
+// alpha, beta and B carry 64 guard bits, so every product has a higher precision than C and
+// temp, and each move assignment either copies (keep_destination) or swaps (adopt_source).
+void _Rgemm_01(int64_t m, int64_t k, int64_t n, const mpf_class &alpha, const mpf_class *A, int64_t lda, const mpf_class *B, int64_t ldb, const mpf_class &beta, mpf_class *C, int64_t ldc) {
+    for (int64_t j = 0; j < n; ++j) {
+        for (int64_t i = 0; i < m; ++i) {
+            C[i + j * ldc] = beta * C[i + j * ldc];
+        }
+    }
+    for (int64_t i = 0; i < m; ++i) {
+        for (int64_t j = 0; j < n; ++j) {
+            mpf_class temp = 0;
+            for (int64_t l = 0; l < k; ++l) {
+                temp = temp + A[i + l * lda] * B[l + j * ldb];
+            }
+            C[i + j * ldc] = C[i + j * ldc] + alpha * temp;
+        }
+    }
+}
+void _Rgemm_02(int64_t m, int64_t k, int64_t n, const mpf_class &alpha, const mpf_class *A, int64_t lda, const mpf_class *B, int64_t ldb, const mpf_class &beta, mpf_class *C, int64_t ldc) {
+    for (int64_t j = 0; j < n; ++j) {
+        for (int64_t i = 0; i < m; ++i) {
+            C[i + j * ldc] = beta * C[i + j * ldc];
+        }
+    }
+    mpf_class temp = 0;
+    for (int64_t j = 0; j < n; ++j) {
+        for (int64_t l = 0; l < k; ++l) {
+            temp = alpha * B[l + j * ldb];
+            for (int64_t i = 0; i < m; ++i) {
+                C[i + j * ldc] = C[i + j * ldc] + temp * A[i + l * lda];
+            }
+        }
+    }
+}
+
+template <typename Kernel> void run(const char *name, Kernel kernel, prec_policy policy, int64_t M, int64_t K, int64_t N, const mpf_class &alpha, const mpf_class *A, const mpf_class *B, const mpf_class &beta, const mpf_class *C0, const mpf_class *C_ref) {
+    mpf_class *C = new mpf_class[M * N];
+    for (int64_t i = 0; i < M * N; ++i)
+        C[i] = C0[i];
+
+    gmpxx_defaults::move_policy = policy;
+#if defined ___GMPXX_MKII_MOVE_STATS___
+    move_assign_statistics before = move_stats;
+#endif
+    auto start = std::chrono::high_resolution_clock::now();
+    kernel(M, K, N, alpha, A, M, B, K, beta, C, M);
+    auto end = std::chrono::high_resolution_clock::now();
+    gmpxx_defaults::move_policy = prec_policy::keep_destination;
+
+    std::chrono::duration<double> elapsed = end - start;
+    mpf_class l1_norm = 0;
+    for (int64_t i = 0; i < M * N; ++i)
+        l1_norm += abs(C[i] - C_ref[i]);
+
+    std::cout << name << (policy == prec_policy::adopt_source ? " adopt_source" : " keep_destination") << std::endl;
+    std::cout << "Elapsed time: " << elapsed.count() << " s" << std::endl;
+    std::cout << "MFLOPS: " << flops_gemm(M, N, K) / (elapsed.count() * MFLOPS) << std::endl;
+#if defined ___GMPXX_MKII_MOVE_STATS___
+    std::cout << "Move assignments: " << move_stats.copies - before.copies << " copies, " << move_stats.swaps - before.swaps << " swaps" << std::endl;
+#endif
+    std::cout << "L1 Norm of difference: ";
+    gmp_printf("%.4Fg\n", l1_norm.get_mpf_t());
+    std::cout << (l1_norm < 1e-5 ? "Result OK" : "Result NG") << std::endl;
+    delete[] C;
+}
+
+int main(int argc, char **argv) {
+    gmp_randclass r(gmp_randinit_default);
+    r.seed(42);
+
+    if (argc != 5) {
+        std::cerr << "Usage: " << argv[0] << " <rows m> <cols k> <cols n> <precision>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int64_t M = std::atoll(argv[1]);
+    int64_t K = std::atoll(argv[2]);
+    int64_t N = std::atoll(argv[3]);
+    int prec = std::atoi(argv[4]);
+    mp_bitcnt_t guard_prec = prec + 64;
+    mpf_set_default_prec(prec);
+
+    mpf_class *A = new mpf_class[M * K];
+    mpf_class *B = new mpf_class[K * N];
+    mpf_class *C = new mpf_class[M * N];
+    mpf_class *C_ref = new mpf_class[M * N];
+
+    mpf_class alpha(r.get_f(prec), guard_prec);
+    mpf_class beta(r.get_f(prec), guard_prec);
+    for (int64_t i = 0; i < M * K; ++i)
+        A[i] = r.get_f(prec);
+    for (int64_t i = 0; i < K * N; ++i) {
+        B[i].set_prec(guard_prec);
+        B[i] = r.get_f(prec);
+    }
+    for (int64_t i = 0; i < M * N; ++i) {
+        C[i] = r.get_f(prec);
+        C_ref[i] = C[i];
+    }
+    Rgemm("n", "n", M, N, K, alpha, A, M, B, K, beta, C_ref, M);
+
+    run("_Rgemm_01", _Rgemm_01, prec_policy::keep_destination, M, K, N, alpha, A, B, beta, C, C_ref);
+    run("_Rgemm_01", _Rgemm_01, prec_policy::adopt_source, M, K, N, alpha, A, B, beta, C, C_ref);
+    run("_Rgemm_02", _Rgemm_02, prec_policy::keep_destination, M, K, N, alpha, A, B, beta, C, C_ref);
+    run("_Rgemm_02", _Rgemm_02, prec_policy::adopt_source, M, K, N, alpha, A, B, beta, C, C_ref);
+
+    delete[] A;
+    delete[] B;
+    delete[] C;
+    delete[] C_ref;
+
+    return EXIT_SUCCESS;
+}
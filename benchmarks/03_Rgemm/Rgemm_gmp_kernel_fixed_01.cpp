@@ -0,0 +1,140 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+#include "gmpxx_mkII.h"
+#if !defined ___GMPXX_STRICT_COMPATIBILITY___
+using namespace gmpxx;
+#endif
+
+#include "Rgemm.hpp"
+
+#define MFLOPS 1e+6
+
+// cf. https://netlib.org/lapack/lawnspdf/lawn41.pdf p.120
+double flops_gemm(int k_i, int m_i, int n_i) {
+    double adds, muls, flops;
+    double k, m, n;
+    m = (double)m_i;
+    n = (double)n_i;
+    k = (double)k_i;
+    muls = m * (k + 2) * n;
+    adds = m * k * n;
+    flops = muls + adds;
+    return flops;
+}
+
+// C = alpha * A * B + beta * C on column-major mpf_fixed<Bits> matrices; the matrices are
+// single contiguous blocks and no element or temporary touches the heap.
+template <mp_bitcnt_t Bits>
+void _Rgemm(int64_t m, int64_t k, int64_t n, const mpf_fixed<Bits> &alpha, const mpf_fixed<Bits> *A, int64_t lda, const mpf_fixed<Bits> *B, int64_t ldb, const mpf_fixed<Bits> &beta, mpf_fixed<Bits> *C, int64_t ldc) {
+    for (int64_t j = 0; j < n; ++j) {
+        for (int64_t i = 0; i < m; ++i) {
+            C[i + j * ldc] *= beta;
+        }
+    }
+
+    for (int64_t i = 0; i < m; ++i) {
+        for (int64_t j = 0; j < n; ++j) {
+            mpf_fixed<Bits> temp = 0;
+            for (int64_t l = 0; l < k; ++l) {
+                temp += A[i + l * lda] * B[l + j * ldb];
+            }
+            C[i + j * ldc] += alpha * temp;
+        }
+    }
+}
+
+template <mp_bitcnt_t Bits> int run(int64_t M, int64_t K, int64_t N) {
+    gmp_randclass r(gmp_randinit_default);
+    r.seed(42);
+
+    mpf_class *A_ref = new mpf_class[M * K];
+    mpf_class *B_ref = new mpf_class[K * N];
+    mpf_class *C_ref = new mpf_class[M * N];
+    mpf_fixed<Bits> *A = new mpf_fixed<Bits>[M * K];
+    mpf_fixed<Bits> *B = new mpf_fixed<Bits>[K * N];
+    mpf_fixed<Bits> *C = new mpf_fixed<Bits>[M * N];
+
+    mpf_class alpha_ref = r.get_f(Bits);
+    mpf_class beta_ref = r.get_f(Bits);
+    mpf_fixed<Bits> alpha = alpha_ref;
+    mpf_fixed<Bits> beta = beta_ref;
+
+    for (int64_t i = 0; i < M * K; ++i) {
+        A_ref[i] = r.get_f(Bits);
+        A[i] = A_ref[i];
+    }
+    for (int64_t i = 0; i < K * N; ++i) {
+        B_ref[i] = r.get_f(Bits);
+        B[i] = B_ref[i];
+    }
+    for (int64_t i = 0; i < M * N; ++i) {
+        C_ref[i] = r.get_f(Bits);
+        C[i] = C_ref[i];
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    _Rgemm(M, K, N, alpha, A, M, B, K, beta, C, M);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    Rgemm("n", "n", M, N, K, alpha_ref, A_ref, M, B_ref, K, beta_ref, C_ref, M);
+
+    std::chrono::duration<double> elapsed = end - start;
+    double mflops = flops_gemm(M, N, K) / (elapsed.count() * MFLOPS);
+
+    std::cout << "Elapsed time: " << elapsed.count() << " s" << std::endl;
+    std::cout << "MFLOPS: " << mflops << std::endl;
+
+    mpf_class l1_norm = 0;
+    for (int64_t i = 0; i < M * N; ++i) {
+        mpf_class diff = abs(mpf_class(C[i]) - C_ref[i]);
+        l1_norm += diff;
+    }
+
+    std::cout << "L1 Norm of difference: ";
+    gmp_printf("%.4Fg\n", l1_norm.get_mpf_t());
+
+    mpf_class threshold = 1e-5;
+    if (l1_norm < threshold) {
+        std::cout << "Result OK" << std::endl;
+    } else {
+        std::cout << "Result NG" << std::endl;
+    }
+
+    delete[] A;
+    delete[] B;
+    delete[] C;
+    delete[] A_ref;
+    delete[] B_ref;
+    delete[] C_ref;
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 5) {
+        std::cerr << "Usage: " << argv[0] << " <rows m> <cols k> <cols n> <precision: 256, 512, 1024 or 2048>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int64_t M = std::atoll(argv[1]);
+    int64_t K = std::atoll(argv[2]);
+    int64_t N = std::atoll(argv[3]);
+    int prec = std::atoi(argv[4]);
+    mpf_set_default_prec(prec);
+
+    switch (prec) {
+    case 256:
+        return run<256>(M, K, N);
+    case 512:
+        return run<512>(M, K, N);
+    case 1024:
+        return run<1024>(M, K, N);
+    case 2048:
+        return run<2048>(M, K, N);
+    default:
+        std::cerr << "Unsupported precision " << prec << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,128 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+#include "gmpxx_mkII.h"
+#if !defined ___GMPXX_STRICT_COMPATIBILITY___
+using namespace gmpxx;
+#endif
+
+#include "Rgemm.hpp"
+
+#define MFLOPS 1e+6
+
+// cf. https://netlib.org/lapack/lawnspdf/lawn41.pdf p.120
+double flops_gemm(int k_i, int m_i, int n_i) {
+    double adds, muls, flops;
+    double k, m, n;
+    m = (double)m_i;
+    n = (double)n_i;
+    k = (double)k_i;
+    muls = m * (k + 2) * n;
+    adds = m * k * n;
+    flops = muls + adds;
+    return flops;
+}
+
+// C = alpha * A * B + beta * C on mpf_matrix; each matrix is one slab of headers and limbs
+void _Rgemm(const mpf_class &alpha, const mpf_matrix &A, const mpf_matrix &B, const mpf_class &beta, mpf_matrix &C) {
+    int64_t m = C.rows(), n = C.cols(), k = A.cols();
+    for (int64_t j = 0; j < n; ++j) {
+        for (int64_t i = 0; i < m; ++i) {
+            C(i, j) *= beta;
+        }
+    }
+
+    mpf_class temp;
+    for (int64_t j = 0; j < n; ++j) {
+        for (int64_t l = 0; l < k; ++l) {
+            temp = alpha;
+            temp *= B(l, j);
+            for (int64_t i = 0; i < m; ++i) {
+                addmul(C(i, j), temp, A(i, l));
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    gmp_randclass r(gmp_randinit_default);
+    r.seed(42);
+
+    if (argc != 5) {
+        std::cerr << "Usage: " << argv[0] << " <rows m> <cols k> <cols n> <precision>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int64_t M = std::atoll(argv[1]);
+    int64_t K = std::atoll(argv[2]);
+    int64_t N = std::atoll(argv[3]);
+    int prec = std::atoi(argv[4]);
+    mpf_set_default_prec(prec);
+
+    // one allocation per matrix against M * K + K * N + M * N for mpf_class arrays
+    auto alloc_start = std::chrono::high_resolution_clock::now();
+    mpf_class *A_ref = new mpf_class[M * K];
+    mpf_class *B_ref = new mpf_class[K * N];
+    mpf_class *C_ref = new mpf_class[M * N];
+    auto alloc_mid = std::chrono::high_resolution_clock::now();
+    mpf_matrix A(M, K), B(K, N), C(M, N);
+    auto alloc_end = std::chrono::high_resolution_clock::now();
+
+    mpf_class alpha = r.get_f(prec);
+    mpf_class beta = r.get_f(prec);
+    for (int64_t j = 0; j < K; ++j) {
+        for (int64_t i = 0; i < M; ++i) {
+            A_ref[i + j * M] = r.get_f(prec);
+            A(i, j) = A_ref[i + j * M];
+        }
+    }
+    for (int64_t j = 0; j < N; ++j) {
+        for (int64_t i = 0; i < K; ++i) {
+            B_ref[i + j * K] = r.get_f(prec);
+            B(i, j) = B_ref[i + j * K];
+        }
+    }
+    for (int64_t j = 0; j < N; ++j) {
+        for (int64_t i = 0; i < M; ++i) {
+            C_ref[i + j * M] = r.get_f(prec);
+            C(i, j) = C_ref[i + j * M];
+        }
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    _Rgemm(alpha, A, B, beta, C);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    Rgemm("n", "n", M, N, K, alpha, A_ref, M, B_ref, K, beta, C_ref, M);
+
+    std::chrono::duration<double> elapsed = end - start;
+    double mflops = flops_gemm(M, N, K) / (elapsed.count() * MFLOPS);
+
+    std::cout << "Allocation time mpf_class[]: " << std::chrono::duration<double>(alloc_mid - alloc_start).count() << " s, mpf_matrix: " << std::chrono::duration<double>(alloc_end - alloc_mid).count() << " s" << std::endl;
+    std::cout << "Elapsed time: " << elapsed.count() << " s" << std::endl;
+    std::cout << "MFLOPS: " << mflops << std::endl;
+
+    mpf_class l1_norm = 0;
+    for (int64_t j = 0; j < N; ++j) {
+        for (int64_t i = 0; i < M; ++i) {
+            l1_norm += abs(C(i, j) - C_ref[i + j * M]);
+        }
+    }
+
+    std::cout << "L1 Norm of difference: ";
+    gmp_printf("%.4Fg\n", l1_norm.get_mpf_t());
+
+    mpf_class threshold = 1e-5;
+    if (l1_norm < threshold) {
+        std::cout << "Result OK" << std::endl;
+    } else {
+        std::cout << "Result NG" << std::endl;
+    }
+
+    delete[] A_ref;
+    delete[] B_ref;
+    delete[] C_ref;
+
+    return EXIT_SUCCESS;
+}
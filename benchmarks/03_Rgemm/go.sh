@@ -15,15 +15,25 @@ executables=(
     "Rgemm_gmp_kernel_03_orig"
     "Rgemm_gmp_kernel_03_mkII"
     "Rgemm_gmp_kernel_03_mkIISR"
+    "Rgemm_gmp_kernel_04_mkII"
+    "Rgemm_gmp_kernel_04_mkIISR"
+    "Rgemm_gmp_kernel_05_mkII"
     "Rgemm_gmp_kernel_openmp_01_orig"
     "Rgemm_gmp_kernel_openmp_01_mkII"
     "Rgemm_gmp_kernel_openmp_01_mkIISR"
+    "Rgemm_gmp_kernel_openmp_01_mkIIpool"
     "Rgemm_gmp_kernel_openmp_02_orig"
     "Rgemm_gmp_kernel_openmp_02_mkII"
     "Rgemm_gmp_kernel_openmp_02_mkIISR"
     "Rgemm_gmp_kernel_openmp_03_orig"
     "Rgemm_gmp_kernel_openmp_03_mkII"
     "Rgemm_gmp_kernel_openmp_03_mkIISR"
+    "Rgemm_gmp_kernel_fixed_01_mkII"
+    "Rgemm_gmp_kernel_01_mkIIET"
+    "Rgemm_gmp_kernel_slab_01_mkII"
+    "Rgemm_gmp_kernel_slab_01_mkIISR"
+    "Rgemm_gmp_kernel_blas_01_mkII"
+    "Rgemm_gmp_kernel_blas_01_mkIISR"
 )
 for exe in "${executables[@]}"; do
     COMMAND_LINE="/usr/bin/time ./$exe 500 500 500 512"
@@ -36,3 +46,12 @@ for exe in "${executables[@]}"; do
     echo
 done
 
+# packed and Strassen-Winograd Rgemm against the plain C kernel at several sizes
+for size in 300 500 700; do
+    for exe in Rgemm_gmp_C_native_02 Rgemm_gmp_kernel_packed_01_mkII Rgemm_gmp_kernel_packed_01_mkIISR Rgemm_gmp_kernel_strassen_01_mkII Rgemm_gmp_kernel_strassen_01_mkIISR; do
+        COMMAND_LINE="/usr/bin/time ./$exe $size $size $size 512"
+        echo $COMMAND_LINE
+        $COMMAND_LINE
+        echo
+    done
+done
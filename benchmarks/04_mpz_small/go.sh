@@ -0,0 +1,14 @@
+uname -a
+cat /proc/cpuinfo | grep 'model name' | head -1
+echo
+executables=(
+    "mpz_small_01_orig"
+    "mpz_small_01_mkII"
+    "mpz_small_01_mkIIsmall"
+)
+for exe in "${executables[@]}"; do
+    COMMAND_LINE="/usr/bin/time ./$exe 10000 1000"
+    echo $COMMAND_LINE
+    $COMMAND_LINE
+    echo
+done
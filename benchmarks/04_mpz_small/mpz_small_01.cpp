@@ -0,0 +1,70 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <gmp.h>
+
+#if defined USE_ORIGINAL_GMPXX
+#include <gmpxx.h>
+#else
+#include "gmpxx_mkII.h"
+#if !defined ___GMPXX_STRICT_COMPATIBILITY___
+using namespace gmpxx;
+#endif
+#endif
+
+#define MOPS 1e+6
+
+// add, mul and compare on values that fit in a signed long
+template <typename F> double elapsed_seconds(F f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <vector size> <repeat>" << std::endl;
+        return 1;
+    }
+    int N = std::atoi(argv[1]);
+    int repeat = std::atoi(argv[2]);
+
+    gmp_randstate_t state;
+    gmp_randinit_default(state);
+    gmp_randseed_ui(state, 42);
+    std::vector<mpz_class> x(N), y(N), z(N);
+    for (int i = 0; i < N; i++) {
+        x[i] = static_cast<signed long int>(gmp_urandomb_ui(state, 20)) - (1L << 19);
+        y[i] = static_cast<signed long int>(gmp_urandomb_ui(state, 20)) - (1L << 19);
+    }
+
+    mpz_class sum = 0;
+    double t_add = elapsed_seconds([&] {
+        for (int r = 0; r < repeat; r++)
+            for (int i = 0; i < N; i++)
+                z[i] = x[i] + y[i];
+    });
+    for (int i = 0; i < N; i++)
+        sum += z[i];
+    double t_mul = elapsed_seconds([&] {
+        for (int r = 0; r < repeat; r++)
+            for (int i = 0; i < N; i++)
+                z[i] = x[i] * y[i];
+    });
+    for (int i = 0; i < N; i++)
+        sum += z[i];
+    long count = 0;
+    double t_cmp = elapsed_seconds([&] {
+        for (int r = 0; r < repeat; r++)
+            for (int i = 0; i < N; i++)
+                count += (x[i] < y[i]) + (x[i] == 0);
+    });
+    double ops = static_cast<double>(N) * repeat;
+    std::cout << "add: " << t_add << " s, " << ops / t_add / MOPS << " MOPS" << std::endl;
+    std::cout << "mul: " << t_mul << " s, " << ops / t_mul / MOPS << " MOPS" << std::endl;
+    std::cout << "cmp: " << t_cmp << " s, " << ops / t_cmp / MOPS << " MOPS" << std::endl;
+    std::cout << "checksum: " << sum << " " << count << std::endl;
+    gmp_randclear(state);
+    return 0;
+}
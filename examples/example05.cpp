@@ -0,0 +1,39 @@
+// calculation of pi: arithmetic-geometric mean vs. Chudnovsky binary splitting
+// usage: example05 [max_digits] (default 10000000)
+// build with -fopenmp to evaluate the binary splitting tree in parallel
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include "gmpxx_mkII.h" // Set the correct path to the mpf_class definition header
+
+template <typename F> double elapsed_seconds(F f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    long max_digits = 10000000;
+    if (argc > 1)
+        max_digits = std::atol(argv[1]);
+
+    std::cout << std::setw(10) << "digits" << std::setw(16) << "AGM [s]" << std::setw(16) << "Chudnovsky [s]" << "  check" << std::endl;
+    for (long digits = 1000; digits <= max_digits; digits *= 10) {
+        mp_bitcnt_t bit_precision = static_cast<mp_bitcnt_t>(std::ceil(digits * std::log2(10)));
+        bit_precision = (bit_precision / 64 + 1) * 64; // GMP rounds precisions up to whole limbs
+        mpf_set_default_prec(bit_precision);
+        gmpxx::mpf_class pi_agm, pi_chudnovsky;
+        double t_agm = elapsed_seconds([&] { pi_agm = gmpxx::const_pi_AGM(bit_precision); });
+        double t_chudnovsky = elapsed_seconds([&] { pi_chudnovsky = gmpxx::const_pi_chudnovsky(bit_precision); });
+
+        gmpxx::mpf_class epsilon(1.0, bit_precision);
+        epsilon.div_2exp(bit_precision - 8);
+        bool ok = gmpxx::abs(pi_agm - pi_chudnovsky) < epsilon;
+        std::cout << std::setw(10) << digits << std::fixed << std::setprecision(4) << std::setw(16) << t_agm << std::setw(16) << t_chudnovsky << "  " << (ok ? "OK" : "NG") << std::endl;
+    }
+    return 0;
+}
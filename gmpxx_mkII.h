@@ -45,9 +45,18 @@
 #include <cstdarg>
 #include <tuple>
 #include <iomanip>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+#include <new>
 
 #define ___MPF_CLASS_EXPLICIT___ explicit
 
+#if defined ___GMPXX_MKII_ZIV___ && defined ___GMPXX_MKII_NOPRECCHANGE___
+#error "___GMPXX_MKII_ZIV___ changes the working precision and cannot be used with ___GMPXX_MKII_NOPRECCHANGE___"
+#endif
+
 #if defined ___GMPXX_STRICT_COMPATIBILITY___
 #define ___GMPXX_DONT_USE_NAMESPACE___
 #define ___GMPXX_UDL_CHAR___
@@ -58,6 +67,12 @@
 #define UNSIGNED_INT_COND(T, X) typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value, X>::type
 #define SIGNED_INT_COND(T, X) typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, X>::type
 #define NON_INT_COND(T, X) typename std::enable_if<std::is_arithmetic<T>::value && !std::is_integral<T>::value, X>::type
+#define EXACT_COND(T, U, C, X) typename std::enable_if<std::is_same<T, C>::value && std::is_same<U, C>::value, X>::type
+#if defined ___GMPXX_MKII_EXPRESSION_TEMPLATES___
+#define NON_MPQ_COND(T, X) typename std::enable_if<!std::is_same<T, mpq_class>::value && !is_mpf_expr<T>::value, X>::type
+#else
+#define NON_MPQ_COND(T, X) typename std::enable_if<!std::is_same<T, mpq_class>::value, X>::type
+#endif
 #define NON_GMP_COND(T, X) typename std::enable_if<!std::is_same<T, mpf_class>::value && !std::is_same<T, mpq_class>::value && !std::is_same<T, mpz_class>::value, X>::type
 
 #if !defined ___GMPXX_DONT_USE_NAMESPACE___
@@ -67,12 +82,40 @@ namespace gmpxx {
 class mpz_class;
 class mpq_class;
 class mpf_class;
+#if defined ___GMPXX_MKII_EXPRESSION_TEMPLATES___
+class mpf_mul_expr;
+class mpf_mul_add_expr;
+class mpf_mul_plus_expr;
+template <typename T> struct is_mpf_expr : std::false_type {};
+#endif
 
+// Algorithms used by const_pi() and const_pi(prec)
+enum class const_pi_algorithm { AGM, chudnovsky };
+// Precision of the destination of a move assignment from a value of another precision (mkII):
+// keep_destination copies the value into the destination, adopt_source swaps, so the destination
+// takes over the limbs and the precision of the source
+enum class prec_policy { keep_destination, adopt_source };
 struct gmpxx_defaults {
     static void set_default_prec(int prec) { mpf_set_default_prec(prec); }
     static mp_bitcnt_t get_default_prec() { return mpf_get_default_prec(); }
     inline static int base = 10;
+    inline static const_pi_algorithm pi_algorithm = const_pi_algorithm::AGM;
+    inline static prec_policy move_policy = prec_policy::keep_destination;
+    // Ziv's strategy (ziv_evaluate, ___GMPXX_MKII_ZIV___): initial guard bits, assumed error
+    // of the kernels in ulps of the working precision (as a power of two; one bound for all
+    // kernels, not proven for any of them), and retry limit
+    inline static mp_bitcnt_t ziv_guard_bits = 32;
+    inline static mp_bitcnt_t ziv_error_bits = 16;
+    inline static unsigned int ziv_max_retries = 8;
+};
+#if defined ___GMPXX_MKII_MOVE_STATS___
+// move assignments of mpf_class done by swapping the limbs and by copying the value
+struct move_assign_statistics {
+    unsigned long swaps = 0;
+    unsigned long copies = 0;
 };
+inline thread_local move_assign_statistics move_stats;
+#endif
 class mpf_class_initializer {
   public:
     mpf_class_initializer() {
@@ -118,17 +161,265 @@ const auto &initializer = mpf_class_initializer_singleton::instance();
 }
 #define ___GMPXX_MKII_INITIALIZER___ mpf_class_initializer_singleton::instance()
 
-template <typename T = void> struct caches {
-    static mpf_class pi_cached;
-    static mpf_class e_cached;
-    static mpf_class log_cached;
-    static mpf_class log2_cached;
+// Thread-local pool allocator, installed through mp_set_memory_functions by
+// install_pool_allocator() or by defining ___GMPXX_MKII_POOL_ALLOCATOR___. Limb arrays of up to
+// max_limbs limbs are kept on per-thread free lists bucketed by limb count instead of being
+// returned to malloc; at a fixed precision GMP requests the same few sizes over and over.
+// Every block is still a separate allocation of the previously installed allocator, so it may
+// be freed by another thread or after uninstall_pool_allocator().
+struct pool_allocator_statistics {
+    unsigned long hits = 0;     // served from a free list
+    unsigned long misses = 0;   // poolable size, but the free list was empty
+    unsigned long bypasses = 0; // not a poolable size
+};
+inline thread_local pool_allocator_statistics pool_stats;
+
+class pool_allocator {
+  public:
+    static constexpr size_t max_limbs = 256;
+    static constexpr size_t max_blocks = 256; // per limb count and thread
+
+    static void install() {
+        if (installed)
+            return;
+        mp_get_memory_functions(&underlying_alloc, &underlying_realloc, &underlying_free);
+        mp_set_memory_functions(allocate, reallocate, deallocate);
+        installed = true;
+    }
+    static void uninstall() {
+        if (!installed)
+            return;
+        mp_set_memory_functions(underlying_alloc, underlying_realloc, underlying_free);
+        installed = false;
+        trim();
+    }
+    static bool is_installed() { return installed; }
+    // returns the blocks on this thread's free lists to the underlying allocator
+    static void trim() {
+        for (size_t n = 1; n <= max_limbs; n++) {
+            while (lists.head[n]) {
+                void *next = *static_cast<void **>(lists.head[n]);
+                underlying_free(lists.head[n], n * sizeof(mp_limb_t));
+                lists.head[n] = next;
+            }
+            lists.count[n] = 0;
+        }
+    }
+
+  private:
+    struct free_lists {
+        void *head[max_limbs + 1];
+        size_t count[max_limbs + 1];
+        bool registered;
+        bool finished;
+    };
+    struct releaser {
+        ~releaser() {
+            trim();
+            lists.finished = true;
+        }
+    };
+    inline static thread_local free_lists lists; // trivially destructible: usable until the thread ends
+    inline static thread_local releaser thread_exit;
+    inline static bool installed = false;
+    inline static void *(*underlying_alloc)(size_t) = nullptr;
+    inline static void *(*underlying_realloc)(void *, size_t, size_t) = nullptr;
+    inline static void (*underlying_free)(void *, size_t) = nullptr;
+
+    static size_t limbs(size_t size) { return (size % sizeof(mp_limb_t) == 0 && size <= max_limbs * sizeof(mp_limb_t)) ? size / sizeof(mp_limb_t) : 0; }
+    static void *allocate(size_t size) {
+        size_t n = limbs(size);
+        if (n == 0) {
+            pool_stats.bypasses++;
+            return underlying_alloc(size);
+        }
+        if (void *p = lists.head[n]) {
+            lists.head[n] = *static_cast<void **>(p);
+            lists.count[n]--;
+            pool_stats.hits++;
+            return p;
+        }
+        pool_stats.misses++;
+        return underlying_alloc(size);
+    }
+    static void *reallocate(void *ptr, size_t old_size, size_t new_size) { return underlying_realloc(ptr, old_size, new_size); }
+    static void deallocate(void *ptr, size_t size) {
+        size_t n = limbs(size);
+        if (n == 0 || lists.finished || lists.count[n] >= max_blocks) {
+            underlying_free(ptr, size);
+            return;
+        }
+        if (!lists.registered) {
+            (void)&thread_exit; // registers the destructor that drains this thread's lists
+            lists.registered = true;
+        }
+        *static_cast<void **>(ptr) = lists.head[n];
+        lists.head[n] = ptr;
+        lists.count[n]++;
+    }
+};
+inline void install_pool_allocator() { pool_allocator::install(); }
+inline void uninstall_pool_allocator() { pool_allocator::uninstall(); }
+#if defined ___GMPXX_MKII_POOL_ALLOCATOR___
+inline const bool pool_allocator_installed_at_startup = (install_pool_allocator(), true);
+#endif
+
+// Scoped arena for temporaries: scratch_scope::get(prec) returns an mpf_t whose limbs are bump
+// allocated from a per-thread arena, and everything taken since the scope was opened is released
+// at once when it closes. Scopes nest (last opened, first closed) and the arena keeps its memory,
+// so repeated calls at the same precision do not allocate. The values must not be passed to
+// mpf_clear, mpf_set_prec or mpf_swap (other than with one another) or be used after the scope.
+struct scratch_arena {
+    std::vector<std::vector<mp_limb_t>> chunks; // moving a chunk keeps its buffer
+    size_t current = 0;                         // chunk in use
+    size_t used = 0;                            // limbs used in it
+    mp_limb_t *allocate(size_t n) {
+        for (;;) {
+            if (current < chunks.size()) {
+                if (used + n <= chunks[current].size()) {
+                    mp_limb_t *p = chunks[current].data() + used;
+                    used += n;
+                    return p;
+                }
+                current++;
+                used = 0;
+                continue;
+            }
+            chunks.emplace_back(std::max<size_t>(n, chunks.empty() ? 1024 : 2 * chunks.back().size()));
+        }
+    }
+};
+class scratch_scope {
+  public:
+    scratch_scope() : chunk(arena.current), used(arena.used) {}
+    ~scratch_scope() {
+        arena.current = chunk;
+        arena.used = used;
+    }
+    scratch_scope(const scratch_scope &) = delete;
+    scratch_scope &operator=(const scratch_scope &) = delete;
+
+    mpf_ptr get(mp_bitcnt_t prec) {
+        const size_t header = (sizeof(__mpf_struct) + sizeof(mp_limb_t) - 1) / sizeof(mp_limb_t);
+        mp_size_t prec_limbs = static_cast<mp_size_t>((std::max<mp_bitcnt_t>(53, prec) + 2 * GMP_NUMB_BITS - 1) / GMP_NUMB_BITS);
+        mp_limb_t *p = arena.allocate(header + prec_limbs + 1);
+        mpf_ptr rop = reinterpret_cast<mpf_ptr>(p);
+        rop->_mp_prec = static_cast<int>(prec_limbs);
+        rop->_mp_size = 0;
+        rop->_mp_exp = 0;
+        rop->_mp_d = p + header;
+        return rop;
+    }
+    mpf_ptr get(mp_bitcnt_t prec, unsigned long int op) {
+        mpf_ptr rop = get(prec);
+        mpf_set_ui(rop, op);
+        return rop;
+    }
+    mpf_ptr get(mp_bitcnt_t prec, mpf_srcptr op) {
+        mpf_ptr rop = get(prec);
+        mpf_set(rop, op);
+        return rop;
+    }
+    // limbs held by the calling thread's arena
+    static size_t reserved_limbs() {
+        size_t total = 0;
+        for (const auto &c : arena.chunks)
+            total += c.size();
+        return total;
+    }
+
+  private:
+    inline static thread_local scratch_arena arena;
+    size_t chunk;
+    size_t used;
 };
-template <typename T> mpf_class caches<T>::pi_cached;
-template <typename T> mpf_class caches<T>::e_cached;
-template <typename T> mpf_class caches<T>::log_cached;
-template <typename T> mpf_class caches<T>::log2_cached;
 
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+// Storage of mpz_class in the small-integer mode (___GMPXX_MKII_SMALL_MPZ___). A value that fits in a
+// signed long is kept in `small` and written to the mpz_t only when an mpz_* function may modify it.
+// set_small() also keeps `view`, a read-only mpz_t over the magnitude in `limb`, so reading through
+// mpz_srcptr has no side effects and is safe from several threads. Taking an mpz_ptr makes the mpz_t
+// the only copy, since the caller may write to it. A pointer obtained from get_mpz_t() therefore
+// goes stale once the value is set again through the other path.
+struct mpz_small_storage {
+    static_assert(std::numeric_limits<unsigned long int>::digits <= GMP_NUMB_BITS, "a signed long must fit in one limb");
+    enum state_type : unsigned char { mpz_only, small_only };
+    mpz_t z;
+    signed long int small = 0;
+    state_type state = mpz_only;
+    mp_limb_t limb = 0;
+    __mpz_struct view;
+
+    mpz_small_storage() noexcept { mpz_roinit_n(&view, &limb, 0); }
+    // copies are shallow, as the mpz_t is owned by mpz_class; `view` is rebuilt over our own limb
+    mpz_small_storage(const mpz_small_storage &op) noexcept : small(op.small), state(op.state), limb(op.limb) {
+        z[0] = op.z[0];
+        mpz_roinit_n(&view, &limb, op.view._mp_size);
+    }
+    mpz_small_storage &operator=(const mpz_small_storage &op) noexcept {
+        z[0] = op.z[0];
+        small = op.small;
+        state = op.state;
+        limb = op.limb;
+        view._mp_size = op.view._mp_size;
+        return *this;
+    }
+
+    bool is_small() const noexcept { return state == small_only; }
+    void set_small(signed long int op) noexcept {
+        small = op;
+        state = small_only;
+        limb = op < 0 ? -static_cast<mp_limb_t>(op) : static_cast<mp_limb_t>(op);
+        view._mp_size = (op > 0) - (op < 0);
+    }
+    operator mpz_srcptr() const { return is_small() ? &view : z; }
+    operator mpz_ptr() {
+        if (state == small_only) {
+            mpz_set_si(z, small);
+            state = mpz_only;
+        }
+        return z;
+    }
+    mpz_srcptr operator->() const { return static_cast<mpz_srcptr>(*this); }
+    mpz_ptr operator->() { return static_cast<mpz_ptr>(*this); }
+
+    // rop = op1 + op2, op1 - op2, op1 * op2 and -op when the operands are small and the result fits
+    // in a signed long; false when the mpz_* functions are needed
+    static bool add(mpz_small_storage &rop, const mpz_small_storage &op1, signed long int op2) noexcept {
+        signed long int r;
+        if (!op1.is_small() || __builtin_add_overflow(op1.small, op2, &r))
+            return false;
+        rop.set_small(r);
+        return true;
+    }
+    static bool sub(mpz_small_storage &rop, const mpz_small_storage &op1, signed long int op2) noexcept {
+        signed long int r;
+        if (!op1.is_small() || __builtin_sub_overflow(op1.small, op2, &r))
+            return false;
+        rop.set_small(r);
+        return true;
+    }
+    static bool sub(mpz_small_storage &rop, signed long int op1, const mpz_small_storage &op2) noexcept {
+        signed long int r;
+        if (!op2.is_small() || __builtin_sub_overflow(op1, op2.small, &r))
+            return false;
+        rop.set_small(r);
+        return true;
+    }
+    static bool mul(mpz_small_storage &rop, const mpz_small_storage &op1, signed long int op2) noexcept {
+        signed long int r;
+        if (!op1.is_small() || __builtin_mul_overflow(op1.small, op2, &r))
+            return false;
+        rop.set_small(r);
+        return true;
+    }
+    static bool add(mpz_small_storage &rop, const mpz_small_storage &op1, const mpz_small_storage &op2) noexcept { return op2.is_small() && add(rop, op1, op2.small); }
+    static bool sub(mpz_small_storage &rop, const mpz_small_storage &op1, const mpz_small_storage &op2) noexcept { return op2.is_small() && sub(rop, op1, op2.small); }
+    static bool mul(mpz_small_storage &rop, const mpz_small_storage &op1, const mpz_small_storage &op2) noexcept { return op2.is_small() && mul(rop, op1, op2.small); }
+    static bool neg(mpz_small_storage &rop, const mpz_small_storage &op) noexcept { return sub(rop, 0L, op); }
+    static bool fits(unsigned long int op) noexcept { return op <= static_cast<unsigned long int>(std::numeric_limits<signed long int>::max()); }
+};
+#endif
 class mpz_class {
   public:
     ////////////////////////////////////////////////////////////////////////////////////////
@@ -141,15 +432,41 @@ class mpz_class {
     // The rule 1 of 5 copy constructor
     mpz_class(const mpz_class &op) {
         mpz_init(value);
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+        if (op.value.is_small()) {
+            value.set_small(op.value.small);
+            return;
+        }
+#endif
         mpz_set(value, op.value);
     }
     // The rule 2 of 5 copy assignment operator
     mpz_class &operator=(const mpz_class &op) noexcept {
         if (this != &op) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+            if (op.value.is_small()) {
+                value.set_small(op.value.small);
+                return *this;
+            }
+#endif
             mpz_set(value, op.value);
         }
         return *this;
     }
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    // The rule 3 of 5 default deconstructor
+    ~mpz_class() { mpz_clear(value.z); }
+    // The rule 4 of 5 move constructor
+    mpz_class(mpz_class &&op) noexcept : value(op.value) {
+        mpz_init(op.value.z);
+        op.value.state = mpz_small_storage::mpz_only;
+    }
+    // The rule 5 of 5 move assignment operator
+    mpz_class &operator=(mpz_class &&op) noexcept {
+        std::swap(value, op.value);
+        return *this;
+    }
+#else
     // The rule 3 of 5 default deconstructor
     ~mpz_class() { mpz_clear(value); }
     // The rule 4 of 5 move constructor
@@ -164,6 +481,7 @@ class mpz_class {
         }
         return *this;
     }
+#endif
     // constructors
     explicit mpz_class(const mpz_t z) {
         mpz_init(value);
@@ -189,11 +507,25 @@ class mpz_class {
             throw std::invalid_argument("");
         }
     }
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    mpz_class(unsigned long int op) {
+        mpz_init(value);
+        *this = op;
+    }
+    mpz_class(signed long int op) {
+        mpz_init(value);
+        value.set_small(op);
+    }
+    mpz_class(double op) { mpz_init_set_d(value, op); }
+    mpz_class(unsigned int op) : mpz_class(static_cast<unsigned long int>(op)) {}
+    mpz_class(signed int op) : mpz_class(static_cast<signed long int>(op)) {}
+#else
     mpz_class(unsigned long int op) { mpz_init_set_ui(value, op); }
     mpz_class(signed long int op) { mpz_init_set_si(value, op); }
     mpz_class(double op) { mpz_init_set_d(value, op); }
     mpz_class(unsigned int op) { mpz_init_set_ui(value, static_cast<unsigned long int>(op)); }
     mpz_class(signed int op) { mpz_init_set_si(value, static_cast<signed long int>(op)); }
+#endif
     // assignments from other objects
     mpz_class &operator=(double d) noexcept {
         mpz_set_d(value, d);
@@ -225,6 +557,10 @@ class mpz_class {
         return result;
     }
     mpz_class &operator++() {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+        if (mpz_small_storage::add(value, value, 1L))
+            return *this;
+#endif
         mpz_add_ui(value, value, 1);
         return *this;
     }
@@ -234,6 +570,10 @@ class mpz_class {
         return original;
     }
     mpz_class &operator--() {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+        if (mpz_small_storage::sub(value, value, 1L))
+            return *this;
+#endif
         mpz_sub_ui(value, value, 1);
         return *this;
     }
@@ -272,6 +612,7 @@ class mpz_class {
     inline friend mpz_class &operator^=(mpz_class &lhs, const mpz_class &rhs);
     inline friend mpz_class operator+(const mpz_class &op);
     inline friend mpz_class operator-(const mpz_class &op);
+    inline friend mpz_class operator-(mpz_class &&op);
     inline friend mpz_class operator+(const mpz_class &op1, const mpz_class &op2);
     inline friend mpz_class operator-(const mpz_class &op1, const mpz_class &op2);
     inline friend mpz_class operator*(const mpz_class &op1, const mpz_class &op2);
@@ -282,12 +623,12 @@ class mpz_class {
     inline friend mpz_class operator^(const mpz_class &op1, const mpz_class &op2);
 
     // mpz_class comparison operators
-    inline friend bool operator==(const mpz_class &op1, const mpz_class &op2) { return mpz_cmp(op1.value, op2.value) == 0; }
-    inline friend bool operator!=(const mpz_class &op1, const mpz_class &op2) { return mpz_cmp(op1.value, op2.value) != 0; }
-    inline friend bool operator<(const mpz_class &op1, const mpz_class &op2) { return mpz_cmp(op1.value, op2.value) < 0; }
-    inline friend bool operator>(const mpz_class &op1, const mpz_class &op2) { return mpz_cmp(op1.value, op2.value) > 0; }
-    inline friend bool operator<=(const mpz_class &op1, const mpz_class &op2) { return mpz_cmp(op1.value, op2.value) <= 0; }
-    inline friend bool operator>=(const mpz_class &op1, const mpz_class &op2) { return mpz_cmp(op1.value, op2.value) >= 0; }
+    inline friend bool operator==(const mpz_class &op1, const mpz_class &op2) { return compare(op1, op2) == 0; }
+    inline friend bool operator!=(const mpz_class &op1, const mpz_class &op2) { return compare(op1, op2) != 0; }
+    inline friend bool operator<(const mpz_class &op1, const mpz_class &op2) { return compare(op1, op2) < 0; }
+    inline friend bool operator>(const mpz_class &op1, const mpz_class &op2) { return compare(op1, op2) > 0; }
+    inline friend bool operator<=(const mpz_class &op1, const mpz_class &op2) { return compare(op1, op2) <= 0; }
+    inline friend bool operator>=(const mpz_class &op1, const mpz_class &op2) { return compare(op1, op2) >= 0; }
 
     inline friend bool operator==(const mpz_class &op1, const double &op2) { return mpz_cmp_d(op1.value, op2) == 0; }
     inline friend bool operator!=(const mpz_class &op1, const double &op2) { return mpz_cmp_d(op1.value, op2) != 0; }
@@ -304,31 +645,31 @@ class mpz_class {
     inline friend bool operator>=(double &op1, const mpz_class &op2) { return mpz_cmp_d(op2.value, op1) <= 0; }
 
     // mpz_class comparison operators (template version)
-    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator==(const mpz_class &op1, T op2) { return mpz_cmp_ui(op1.value, static_cast<unsigned long int>(op2)) == 0; }
-    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator!=(const mpz_class &op1, T op2) { return mpz_cmp_ui(op1.value, static_cast<unsigned long int>(op2)) != 0; }
-    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator<(const mpz_class &op1, T op2) { return mpz_cmp_ui(op1.value, static_cast<unsigned long int>(op2)) < 0; }
-    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator>(const mpz_class &op1, T op2) { return mpz_cmp_ui(op1.value, static_cast<unsigned long int>(op2)) > 0; }
-    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator<=(const mpz_class &op1, T op2) { return mpz_cmp_ui(op1.value, static_cast<unsigned long int>(op2)) <= 0; }
-    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator>=(const mpz_class &op1, T op2) { return mpz_cmp_ui(op1.value, static_cast<unsigned long int>(op2)) >= 0; }
-    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator==(T op1, const mpz_class &op2) { return mpz_cmp_ui(op2.value, static_cast<unsigned long int>(op1)) == 0; }
-    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator!=(T op1, const mpz_class &op2) { return mpz_cmp_ui(op2.value, static_cast<unsigned long int>(op1)) != 0; }
-    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator<(T op1, const mpz_class &op2) { return mpz_cmp_ui(op2.value, static_cast<unsigned long int>(op1)) > 0; }
-    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator>(T op1, const mpz_class &op2) { return mpz_cmp_ui(op2.value, static_cast<unsigned long int>(op1)) < 0; }
-    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator<=(T op1, const mpz_class &op2) { return mpz_cmp_ui(op2.value, static_cast<unsigned long int>(op1)) >= 0; }
-    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator>=(T op1, const mpz_class &op2) { return mpz_cmp_ui(op2.value, static_cast<unsigned long int>(op1)) <= 0; }
-
-    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator==(const mpz_class &op1, T op2) { return mpz_cmp_si(op1.value, static_cast<signed long int>(op2)) == 0; }
-    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator!=(const mpz_class &op1, T op2) { return mpz_cmp_si(op1.value, static_cast<signed long int>(op2)) != 0; }
-    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator<(const mpz_class &op1, T op2) { return mpz_cmp_si(op1.value, static_cast<signed long int>(op2)) < 0; }
-    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator>(const mpz_class &op1, T op2) { return mpz_cmp_si(op1.value, static_cast<signed long int>(op2)) > 0; }
-    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator<=(const mpz_class &op1, T op2) { return mpz_cmp_si(op1.value, static_cast<signed long int>(op2)) <= 0; }
-    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator>=(const mpz_class &op1, T op2) { return mpz_cmp_si(op1.value, static_cast<signed long int>(op2)) >= 0; }
-    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator==(T op1, const mpz_class &op2) { return mpz_cmp_si(op2.value, static_cast<signed long int>(op1)) == 0; }
-    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator!=(T op1, const mpz_class &op2) { return mpz_cmp_si(op2.value, static_cast<signed long int>(op1)) != 0; }
-    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator<(T op1, const mpz_class &op2) { return mpz_cmp_si(op2.value, static_cast<signed long int>(op1)) > 0; }
-    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator>(T op1, const mpz_class &op2) { return mpz_cmp_si(op2.value, static_cast<signed long int>(op1)) < 0; }
-    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator<=(T op1, const mpz_class &op2) { return mpz_cmp_si(op2.value, static_cast<signed long int>(op1)) >= 0; }
-    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator>=(T op1, const mpz_class &op2) { return mpz_cmp_si(op2.value, static_cast<signed long int>(op1)) <= 0; }
+    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator==(const mpz_class &op1, T op2) { return compare_ui(op1, static_cast<unsigned long int>(op2)) == 0; }
+    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator!=(const mpz_class &op1, T op2) { return compare_ui(op1, static_cast<unsigned long int>(op2)) != 0; }
+    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator<(const mpz_class &op1, T op2) { return compare_ui(op1, static_cast<unsigned long int>(op2)) < 0; }
+    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator>(const mpz_class &op1, T op2) { return compare_ui(op1, static_cast<unsigned long int>(op2)) > 0; }
+    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator<=(const mpz_class &op1, T op2) { return compare_ui(op1, static_cast<unsigned long int>(op2)) <= 0; }
+    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator>=(const mpz_class &op1, T op2) { return compare_ui(op1, static_cast<unsigned long int>(op2)) >= 0; }
+    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator==(T op1, const mpz_class &op2) { return compare_ui(op2, static_cast<unsigned long int>(op1)) == 0; }
+    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator!=(T op1, const mpz_class &op2) { return compare_ui(op2, static_cast<unsigned long int>(op1)) != 0; }
+    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator<(T op1, const mpz_class &op2) { return compare_ui(op2, static_cast<unsigned long int>(op1)) > 0; }
+    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator>(T op1, const mpz_class &op2) { return compare_ui(op2, static_cast<unsigned long int>(op1)) < 0; }
+    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator<=(T op1, const mpz_class &op2) { return compare_ui(op2, static_cast<unsigned long int>(op1)) >= 0; }
+    template <typename T> inline friend UNSIGNED_INT_COND(T, bool) operator>=(T op1, const mpz_class &op2) { return compare_ui(op2, static_cast<unsigned long int>(op1)) <= 0; }
+
+    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator==(const mpz_class &op1, T op2) { return compare_si(op1, static_cast<signed long int>(op2)) == 0; }
+    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator!=(const mpz_class &op1, T op2) { return compare_si(op1, static_cast<signed long int>(op2)) != 0; }
+    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator<(const mpz_class &op1, T op2) { return compare_si(op1, static_cast<signed long int>(op2)) < 0; }
+    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator>(const mpz_class &op1, T op2) { return compare_si(op1, static_cast<signed long int>(op2)) > 0; }
+    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator<=(const mpz_class &op1, T op2) { return compare_si(op1, static_cast<signed long int>(op2)) <= 0; }
+    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator>=(const mpz_class &op1, T op2) { return compare_si(op1, static_cast<signed long int>(op2)) >= 0; }
+    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator==(T op1, const mpz_class &op2) { return compare_si(op2, static_cast<signed long int>(op1)) == 0; }
+    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator!=(T op1, const mpz_class &op2) { return compare_si(op2, static_cast<signed long int>(op1)) != 0; }
+    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator<(T op1, const mpz_class &op2) { return compare_si(op2, static_cast<signed long int>(op1)) > 0; }
+    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator>(T op1, const mpz_class &op2) { return compare_si(op2, static_cast<signed long int>(op1)) < 0; }
+    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator<=(T op1, const mpz_class &op2) { return compare_si(op2, static_cast<signed long int>(op1)) >= 0; }
+    template <typename T> inline friend SIGNED_INT_COND(T, bool) operator>=(T op1, const mpz_class &op2) { return compare_si(op2, static_cast<signed long int>(op1)) <= 0; }
 
     template <typename T> inline friend NON_INT_COND(T, bool) operator==(const mpz_class &op1, T op2) { return mpz_cmp(op1.value, mpz_class(op2).get_mpz_t()) == 0; }
     template <typename T> inline friend NON_INT_COND(T, bool) operator!=(const mpz_class &op1, T op2) { return mpz_cmp(op1.value, mpz_class(op2).get_mpz_t()) != 0; }
@@ -444,8 +785,13 @@ class mpz_class {
     // long mpz_class::get_si (void)
     // unsigned long mpz_class::get_ui (void)
     inline double get_d() const { return mpz_get_d(value); }
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    inline signed long int get_si() const { return value.is_small() ? value.small : mpz_get_si(value); }
+    inline unsigned long int get_ui() const { return value.is_small() ? static_cast<unsigned long int>(value.small < 0 ? 0UL - static_cast<unsigned long int>(value.small) : value.small) : mpz_get_ui(value); }
+#else
     inline signed long int get_si() const { return mpz_get_si(value); }
     inline unsigned long int get_ui() const { return mpz_get_ui(value); }
+#endif
     // string mpz_class::get_str (int base = 10)
     inline std::string get_str(int base = 10) const {
         char *temp = mpz_get_str(nullptr, base, value);
@@ -532,9 +878,13 @@ class mpz_class {
 
     // void mpz_class::swap (mpz_class& op)
     // void swap (mpz_class& op1, mpz_class& op2)
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    void swap(mpz_class &op) { std::swap(this->value, op.value); }
+#else
     void swap(mpz_class &op) { mpz_swap(this->value, op.value); }
+#endif
 #if !defined ___GMPXX_STRICT_COMPATIBILITY___
-    friend void swap(mpz_class &op1, mpz_class &op2) { mpz_swap(op1.value, op2.value); }
+    friend void swap(mpz_class &op1, mpz_class &op2) { op1.swap(op2); }
 #endif
     friend std::ostream &operator<<(std::ostream &os, const mpz_class &op);
     friend std::ostream &operator<<(std::ostream &os, const mpz_t op);
@@ -554,17 +904,58 @@ class mpz_class {
     mpz_ptr get_mpz_t() { return value; }
 
   private:
+    static int compare(const mpz_class &op1, const mpz_class &op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+        if (op1.value.is_small() && op2.value.is_small())
+            return (op1.value.small > op2.value.small) - (op1.value.small < op2.value.small);
+#endif
+        return mpz_cmp(op1.value, op2.value);
+    }
+    static int compare_si(const mpz_class &op1, signed long int op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+        if (op1.value.is_small())
+            return (op1.value.small > op2) - (op1.value.small < op2);
+#endif
+        return mpz_cmp_si(op1.value, op2);
+    }
+    static int compare_ui(const mpz_class &op1, unsigned long int op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+        if (op1.value.is_small()) {
+            if (op1.value.small < 0)
+                return -1;
+            unsigned long int _op1 = static_cast<unsigned long int>(op1.value.small);
+            return (_op1 > op2) - (_op1 < op2);
+        }
+#endif
+        return mpz_cmp_ui(op1.value, op2);
+    }
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    mpz_small_storage value;
+#else
     mpz_t value;
+#endif
 };
 inline mpz_class &operator+=(mpz_class &op1, const mpz_class &op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    if (mpz_small_storage::add(op1.value, op1.value, op2.value))
+        return op1;
+#endif
     mpz_add(op1.value, op1.value, op2.value);
     return op1;
 }
 inline mpz_class &operator-=(mpz_class &op1, const mpz_class &op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    if (mpz_small_storage::sub(op1.value, op1.value, op2.value))
+        return op1;
+#endif
     mpz_sub(op1.value, op1.value, op2.value);
     return op1;
 }
 inline mpz_class &operator*=(mpz_class &op1, const mpz_class &op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    if (mpz_small_storage::mul(op1.value, op1.value, op2.value))
+        return op1;
+#endif
     mpz_mul(op1.value, op1.value, op2.value);
     return op1;
 }
@@ -591,21 +982,37 @@ inline mpz_class &operator%=(mpz_class &op1, const mpz_class &op2) {
 inline mpz_class operator+(const mpz_class &op) { return op; }
 inline mpz_class operator-(const mpz_class &op) {
     mpz_class result;
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    if (mpz_small_storage::neg(result.value, op.value))
+        return result;
+#endif
     mpz_neg(result.value, op.value);
     return result;
 }
 inline mpz_class operator+(const mpz_class &op1, const mpz_class &op2) {
     mpz_class result;
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    if (mpz_small_storage::add(result.value, op1.value, op2.value))
+        return result;
+#endif
     mpz_add(result.value, op1.value, op2.value);
     return result;
 }
 inline mpz_class operator-(const mpz_class &op1, const mpz_class &op2) {
     mpz_class result;
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    if (mpz_small_storage::sub(result.value, op1.value, op2.value))
+        return result;
+#endif
     mpz_sub(result.value, op1.value, op2.value);
     return result;
 }
 inline mpz_class operator*(const mpz_class &op1, const mpz_class &op2) {
     mpz_class result;
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    if (mpz_small_storage::mul(result.value, op1.value, op2.value))
+        return result;
+#endif
     mpz_mul(result.value, op1.value, op2.value);
     return result;
 }
@@ -619,6 +1026,79 @@ inline mpz_class operator%(const mpz_class &op1, const mpz_class &op2) {
     mpz_tdiv_r(result.value, op1.value, op2.value);
     return result;
 }
+// rvalue operands: the result is computed in place into an expiring temporary, so that
+// a + b + c + d allocates once instead of once per operator. The overloads are templates whose
+// parameters are all deduced and restricted to mpz_class, so that they never compete with the
+// mixed-type operators and never convert an operand into the temporary.
+template <typename U, typename T> inline EXACT_COND(U, T, mpz_class, mpz_class) operator+(U &&op1, const T &op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    op1 += op2;
+#else
+    mpz_add(op1.get_mpz_t(), op1.get_mpz_t(), op2.get_mpz_t());
+#endif
+    return std::move(op1);
+}
+template <typename T, typename U> inline EXACT_COND(T, U, mpz_class, mpz_class) operator+(const T &op1, U &&op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    op2 += op1;
+#else
+    mpz_add(op2.get_mpz_t(), op1.get_mpz_t(), op2.get_mpz_t());
+#endif
+    return std::move(op2);
+}
+template <typename U, typename T> inline EXACT_COND(U, T, mpz_class, mpz_class) operator+(U &&op1, T &&op2) { return std::move(op1) + op2; }
+template <typename U, typename T> inline EXACT_COND(U, T, mpz_class, mpz_class) operator-(U &&op1, const T &op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    op1 -= op2;
+#else
+    mpz_sub(op1.get_mpz_t(), op1.get_mpz_t(), op2.get_mpz_t());
+#endif
+    return std::move(op1);
+}
+template <typename T, typename U> inline EXACT_COND(T, U, mpz_class, mpz_class) operator-(const T &op1, U &&op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    op2 -= op1;
+    return -std::move(op2);
+#else
+    mpz_sub(op2.get_mpz_t(), op1.get_mpz_t(), op2.get_mpz_t());
+    return std::move(op2);
+#endif
+}
+template <typename U, typename T> inline EXACT_COND(U, T, mpz_class, mpz_class) operator-(U &&op1, T &&op2) { return std::move(op1) - op2; }
+template <typename U, typename T> inline EXACT_COND(U, T, mpz_class, mpz_class) operator*(U &&op1, const T &op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    op1 *= op2;
+#else
+    mpz_mul(op1.get_mpz_t(), op1.get_mpz_t(), op2.get_mpz_t());
+#endif
+    return std::move(op1);
+}
+template <typename T, typename U> inline EXACT_COND(T, U, mpz_class, mpz_class) operator*(const T &op1, U &&op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    op2 *= op1;
+#else
+    mpz_mul(op2.get_mpz_t(), op1.get_mpz_t(), op2.get_mpz_t());
+#endif
+    return std::move(op2);
+}
+template <typename U, typename T> inline EXACT_COND(U, T, mpz_class, mpz_class) operator*(U &&op1, T &&op2) { return std::move(op1) * op2; }
+template <typename U, typename T> inline EXACT_COND(U, T, mpz_class, mpz_class) operator/(U &&op1, const T &op2) {
+    mpz_tdiv_q(op1.get_mpz_t(), op1.get_mpz_t(), op2.get_mpz_t());
+    return std::move(op1);
+}
+template <typename T, typename U> inline EXACT_COND(T, U, mpz_class, mpz_class) operator/(const T &op1, U &&op2) {
+    mpz_tdiv_q(op2.get_mpz_t(), op1.get_mpz_t(), op2.get_mpz_t());
+    return std::move(op2);
+}
+template <typename U, typename T> inline EXACT_COND(U, T, mpz_class, mpz_class) operator/(U &&op1, T &&op2) { return std::move(op1) / op2; }
+inline mpz_class operator-(mpz_class &&op) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    if (mpz_small_storage::neg(op.value, op.value))
+        return std::move(op);
+#endif
+    mpz_neg(op.get_mpz_t(), op.get_mpz_t());
+    return std::move(op);
+}
 inline mpz_class operator&(const mpz_class &op1, const mpz_class &op2) {
     mpz_class result;
     mpz_and(result.value, op1.value, op2.value);
@@ -637,10 +1117,18 @@ inline mpz_class operator^(const mpz_class &op1, const mpz_class &op2) {
 
 // +=
 template <typename T> inline UNSIGNED_INT_COND(T, mpz_class &) operator+=(mpz_class &lhs, const T rhs) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    if (mpz_small_storage::fits(rhs) && mpz_small_storage::add(lhs.value, lhs.value, static_cast<signed long int>(rhs)))
+        return lhs;
+#endif
     mpz_add_ui(lhs.value, lhs.value, static_cast<unsigned long int>(rhs));
     return lhs;
 }
 template <typename T> inline SIGNED_INT_COND(T, mpz_class &) operator+=(mpz_class &lhs, const T rhs) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    if (mpz_small_storage::add(lhs.value, lhs.value, static_cast<signed long int>(rhs)))
+        return lhs;
+#endif
     if (rhs >= 0)
         mpz_add_ui(lhs.value, lhs.value, static_cast<unsigned long int>(rhs));
     else {
@@ -655,17 +1143,38 @@ template <typename T> inline NON_INT_COND(T, mpz_class &) operator+=(mpz_class &
 }
 // +
 template <typename T> inline UNSIGNED_INT_COND(T, mpz_class) operator+(const mpz_class &op1, const T op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    mpz_class result;
+    if (mpz_small_storage::fits(op2) && mpz_small_storage::add(result.value, op1.value, static_cast<signed long int>(op2)))
+        return result;
+    result = op1;
+#else
     mpz_class result(op1);
+#endif
     mpz_add_ui(result.value, result.value, static_cast<unsigned long int>(op2));
     return result;
 }
 template <typename T> inline UNSIGNED_INT_COND(T, mpz_class) operator+(const T op1, const mpz_class &op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    mpz_class result;
+    if (mpz_small_storage::fits(op1) && mpz_small_storage::add(result.value, op2.value, static_cast<signed long int>(op1)))
+        return result;
+    result = op2;
+#else
     mpz_class result(op2);
+#endif
     mpz_add_ui(result.value, result.value, static_cast<unsigned long int>(op1));
     return result;
 }
 template <typename T> inline SIGNED_INT_COND(T, mpz_class) operator+(const mpz_class &op1, const T op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    mpz_class result;
+    if (mpz_small_storage::add(result.value, op1.value, static_cast<signed long int>(op2)))
+        return result;
+    result = op1;
+#else
     mpz_class result(op1);
+#endif
     if (op2 >= 0)
         mpz_add_ui(result.value, result.value, static_cast<unsigned long int>(op2));
     else {
@@ -674,7 +1183,14 @@ template <typename T> inline SIGNED_INT_COND(T, mpz_class) operator+(const mpz_c
     return result;
 }
 template <typename T> inline SIGNED_INT_COND(T, mpz_class) operator+(const T op1, const mpz_class &op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    mpz_class result;
+    if (mpz_small_storage::add(result.value, op2.value, static_cast<signed long int>(op1)))
+        return result;
+    result = op2;
+#else
     mpz_class result(op2);
+#endif
     if (op1 >= 0)
         mpz_add_ui(result.value, result.value, static_cast<unsigned long int>(op1));
     else
@@ -690,10 +1206,18 @@ template <typename T> inline NON_INT_COND(T, mpz_class) operator+(const T op1, c
 
 // -=
 template <typename T> inline UNSIGNED_INT_COND(T, mpz_class &) operator-=(mpz_class &lhs, const T rhs) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    if (mpz_small_storage::fits(rhs) && mpz_small_storage::sub(lhs.value, lhs.value, static_cast<signed long int>(rhs)))
+        return lhs;
+#endif
     mpz_sub_ui(lhs.value, lhs.value, static_cast<unsigned long int>(rhs));
     return lhs;
 }
 template <typename T> inline SIGNED_INT_COND(T, mpz_class &) operator-=(mpz_class &lhs, const T rhs) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    if (mpz_small_storage::sub(lhs.value, lhs.value, static_cast<signed long int>(rhs)))
+        return lhs;
+#endif
     if (rhs >= 0)
         mpz_sub_ui(lhs.value, lhs.value, static_cast<unsigned long int>(rhs));
     else {
@@ -709,16 +1233,34 @@ template <typename T> inline NON_INT_COND(T, mpz_class &) operator-=(mpz_class &
 // -
 template <typename T> inline UNSIGNED_INT_COND(T, mpz_class) operator-(const mpz_class &op1, const T op2) {
     mpz_class result;
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    if (mpz_small_storage::fits(op2) && mpz_small_storage::sub(result.value, op1.value, static_cast<signed long int>(op2)))
+        return result;
+#endif
     mpz_sub_ui(result.value, op1.value, op2);
     return result;
 }
 template <typename T> inline UNSIGNED_INT_COND(T, mpz_class) operator-(const T op1, const mpz_class &op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    mpz_class result;
+    if (mpz_small_storage::fits(op1) && mpz_small_storage::sub(result.value, static_cast<signed long int>(op1), op2.value))
+        return result;
+    result = op1;
+#else
     mpz_class result(op1);
+#endif
     mpz_ui_sub(result.value, op1, op2.value);
     return result;
 }
 template <typename T> inline SIGNED_INT_COND(T, mpz_class) operator-(const mpz_class &op1, const T op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    mpz_class result;
+    if (mpz_small_storage::sub(result.value, op1.value, static_cast<signed long int>(op2)))
+        return result;
+    result = op1;
+#else
     mpz_class result(op1);
+#endif
     if (op2 >= 0)
         mpz_sub_ui(result.value, op1.value, static_cast<unsigned long int>(op2));
     else
@@ -728,6 +1270,10 @@ template <typename T> inline SIGNED_INT_COND(T, mpz_class) operator-(const mpz_c
 }
 template <typename T> inline SIGNED_INT_COND(T, mpz_class) operator-(const T op1, const mpz_class &op2) {
     mpz_class result;
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    if (mpz_small_storage::sub(result.value, static_cast<signed long int>(op1), op2.value))
+        return result;
+#endif
     if (op1 >= 0) {
         mpz_ui_sub(result.value, static_cast<unsigned long int>(op1), op2.value);
     } else {
@@ -749,10 +1295,18 @@ template <typename T> inline NON_INT_COND(T, mpz_class) operator-(const T op1, c
 
 // *=
 template <typename T> inline UNSIGNED_INT_COND(T, mpz_class &) operator*=(mpz_class &lhs, const T rhs) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    if (mpz_small_storage::fits(rhs) && mpz_small_storage::mul(lhs.value, lhs.value, static_cast<signed long int>(rhs)))
+        return lhs;
+#endif
     mpz_mul_ui(lhs.value, lhs.value, static_cast<unsigned long int>(rhs));
     return lhs;
 }
 template <typename T> inline SIGNED_INT_COND(T, mpz_class &) operator*=(mpz_class &lhs, const T rhs) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    if (mpz_small_storage::mul(lhs.value, lhs.value, static_cast<signed long int>(rhs)))
+        return lhs;
+#endif
     mpz_mul_si(lhs.value, lhs.value, static_cast<signed long int>(rhs));
     return lhs;
 }
@@ -763,22 +1317,50 @@ template <typename T> inline NON_INT_COND(T, mpz_class &) operator*=(mpz_class &
 }
 // *
 template <typename T> inline UNSIGNED_INT_COND(T, mpz_class) operator*(const mpz_class &op1, const T op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    mpz_class result;
+    if (mpz_small_storage::fits(op2) && mpz_small_storage::mul(result.value, op1.value, static_cast<signed long int>(op2)))
+        return result;
+    result = op1;
+#else
     mpz_class result(op1);
+#endif
     mpz_mul_ui(result.value, result.value, static_cast<unsigned long int>(op2));
     return result;
 }
 template <typename T> inline UNSIGNED_INT_COND(T, mpz_class) operator*(const T op1, const mpz_class &op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    mpz_class result;
+    if (mpz_small_storage::fits(op1) && mpz_small_storage::mul(result.value, op2.value, static_cast<signed long int>(op1)))
+        return result;
+    result = op2;
+#else
     mpz_class result(op2);
+#endif
     mpz_mul_ui(result.value, result.value, static_cast<unsigned long int>(op1));
     return result;
 }
 template <typename T> inline SIGNED_INT_COND(T, mpz_class) operator*(const mpz_class &op1, const T op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    mpz_class result;
+    if (mpz_small_storage::mul(result.value, op1.value, static_cast<signed long int>(op2)))
+        return result;
+    result = op1;
+#else
     mpz_class result(op1);
+#endif
     mpz_mul_si(result.value, result.value, static_cast<signed long int>(op2));
     return result;
 }
 template <typename T> inline SIGNED_INT_COND(T, mpz_class) operator*(const T op1, const mpz_class &op2) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    mpz_class result;
+    if (mpz_small_storage::mul(result.value, op2.value, static_cast<signed long int>(op1)))
+        return result;
+    result = op2;
+#else
     mpz_class result(op2);
+#endif
     mpz_mul_si(result.value, result.value, static_cast<signed long int>(op1));
     return result;
 }
@@ -1041,18 +1623,34 @@ template <typename T> inline NON_INT_COND(T, mpz_class) operator^(const T op1, c
 
 /////
 inline mpz_class &mpz_class::operator=(const signed long int op) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    value.set_small(op);
+    return *this;
+#endif
     mpz_set_si(this->value, op);
     return *this;
 }
 inline mpz_class &mpz_class::operator=(const unsigned long int op) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    if (mpz_small_storage::fits(op)) {
+        value.set_small(static_cast<signed long int>(op));
+        return *this;
+    }
+#endif
     mpz_set_ui(this->value, op);
     return *this;
 }
 inline mpz_class &mpz_class::operator=(const signed int op) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    return *this = static_cast<signed long int>(op);
+#endif
     mpz_set_si(this->value, static_cast<signed long int>(op));
     return *this;
 }
 inline mpz_class &mpz_class::operator=(const unsigned int op) {
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+    return *this = static_cast<unsigned long int>(op);
+#endif
     mpz_set_ui(this->value, static_cast<unsigned long int>(op));
     return *this;
 }
@@ -1075,7 +1673,11 @@ inline mpz_class abs(const mpz_class &op) {
     mpz_abs(result.value, op.value);
     return result;
 }
+#if defined ___GMPXX_MKII_SMALL_MPZ___
+inline int sgn(const mpz_class &op) { return op.value.is_small() ? (op.value.small > 0) - (op.value.small < 0) : mpz_sgn(op.value); }
+#else
 inline int sgn(const mpz_class &op) { return mpz_sgn(op.value); }
+#endif
 inline mpz_class sqrt(const mpz_class &op) {
     mpz_class result;
     mpz_sqrt(result.value, op.value);
@@ -1091,6 +1693,47 @@ inline mpz_class lcm(const mpz_class &op1, const mpz_class &op2) {
     mpz_lcm(result.value, op1.value, op2.value);
     return result;
 }
+// fused multiply-add: addmul(acc, a, b) is acc += a * b and submul(acc, a, b) is acc -= a * b
+// without a temporary, fma(a, b, c) is a * b + c and fms(a, b, c) is a * b - c
+inline mpz_class &addmul(mpz_class &acc, const mpz_class &a, const mpz_class &b) {
+    mpz_addmul(acc.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+    return acc;
+}
+inline mpz_class &submul(mpz_class &acc, const mpz_class &a, const mpz_class &b) {
+    mpz_submul(acc.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+    return acc;
+}
+inline mpz_class &addmul_ui(mpz_class &acc, const mpz_class &a, unsigned long int b) {
+    mpz_addmul_ui(acc.get_mpz_t(), a.get_mpz_t(), b);
+    return acc;
+}
+inline mpz_class &submul_ui(mpz_class &acc, const mpz_class &a, unsigned long int b) {
+    mpz_submul_ui(acc.get_mpz_t(), a.get_mpz_t(), b);
+    return acc;
+}
+template <typename T> inline UNSIGNED_INT_COND(T, mpz_class &) addmul(mpz_class &acc, const mpz_class &a, const T b) { return addmul_ui(acc, a, static_cast<unsigned long int>(b)); }
+template <typename T> inline UNSIGNED_INT_COND(T, mpz_class &) submul(mpz_class &acc, const mpz_class &a, const T b) { return submul_ui(acc, a, static_cast<unsigned long int>(b)); }
+template <typename T> inline SIGNED_INT_COND(T, mpz_class &) addmul(mpz_class &acc, const mpz_class &a, const T b) {
+    if (b >= 0)
+        return addmul_ui(acc, a, static_cast<unsigned long int>(b));
+    return submul_ui(acc, a, 0UL - static_cast<unsigned long int>(b));
+}
+template <typename T> inline SIGNED_INT_COND(T, mpz_class &) submul(mpz_class &acc, const mpz_class &a, const T b) {
+    if (b >= 0)
+        return submul_ui(acc, a, static_cast<unsigned long int>(b));
+    return addmul_ui(acc, a, 0UL - static_cast<unsigned long int>(b));
+}
+inline mpz_class fma(const mpz_class &a, const mpz_class &b, const mpz_class &c) {
+    mpz_class result(c);
+    mpz_addmul(result.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+    return result;
+}
+inline mpz_class fms(const mpz_class &a, const mpz_class &b, const mpz_class &c) {
+    mpz_class result;
+    mpz_mul(result.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+    mpz_sub(result.get_mpz_t(), result.get_mpz_t(), c.get_mpz_t());
+    return result;
+}
 inline mpz_class factorial(const mpz_class &n) {
     if (n < 0) {
         throw std::domain_error("factorial(negative)");
@@ -1545,23 +2188,23 @@ class mpq_class {
         mpq_add(lhs.value, lhs.value, _rhs.value);
         return lhs;
     }
-    template <typename T> inline friend mpq_class operator+(const mpq_class &op1, const T op2) {
+    template <typename T> inline friend NON_MPQ_COND(T, mpq_class) operator+(const mpq_class &op1, const T op2) {
         mpq_class result(op2);
         mpq_add(result.value, op1.value, result.value);
         return result;
     }
-    template <typename T> inline friend mpq_class operator+(const T op1, const mpq_class &op2) { return op2 + op1; }
+    template <typename T> inline friend NON_MPQ_COND(T, mpq_class) operator+(const T op1, const mpq_class &op2) { return op2 + op1; }
     template <typename T> inline friend mpq_class &operator-=(mpq_class &lhs, const T rhs) {
         mpq_class _rhs(rhs);
         mpq_sub(lhs.value, lhs.value, _rhs.value);
         return lhs;
     }
-    template <typename T> inline friend mpq_class operator-(const mpq_class &op1, const T op2) {
+    template <typename T> inline friend NON_MPQ_COND(T, mpq_class) operator-(const mpq_class &op1, const T op2) {
         mpq_class result(op2);
         mpq_sub(result.value, op1.value, result.value);
         return result;
     }
-    template <typename T> inline friend mpq_class operator-(const T op1, const mpq_class &op2) {
+    template <typename T> inline friend NON_MPQ_COND(T, mpq_class) operator-(const T op1, const mpq_class &op2) {
         mpq_class result(op1);
         mpq_sub(result.value, result.value, op2.value);
         return result;
@@ -1571,23 +2214,23 @@ class mpq_class {
         mpq_mul(lhs.value, lhs.value, _rhs.value);
         return lhs;
     }
-    template <typename T> inline friend mpq_class operator*(const mpq_class &op1, const T op2) {
+    template <typename T> inline friend NON_MPQ_COND(T, mpq_class) operator*(const mpq_class &op1, const T op2) {
         mpq_class result(op2);
         mpq_mul(result.value, op1.value, result.value);
         return result;
     }
-    template <typename T> inline friend mpq_class operator*(const T op1, const mpq_class &op2) { return op2 * op1; }
+    template <typename T> inline friend NON_MPQ_COND(T, mpq_class) operator*(const T op1, const mpq_class &op2) { return op2 * op1; }
     template <typename T> inline friend mpq_class &operator/=(mpq_class &lhs, const T rhs) {
         mpq_class _rhs(rhs);
         mpq_div(lhs.value, lhs.value, _rhs.value);
         return lhs;
     }
-    template <typename T> inline friend mpq_class operator/(const mpq_class &op1, const T op2) {
+    template <typename T> inline friend NON_MPQ_COND(T, mpq_class) operator/(const mpq_class &op1, const T op2) {
         mpq_class result(op2);
         mpq_div(result.value, op1.value, result.value);
         return result;
     }
-    template <typename T> inline friend mpq_class operator/(const T op1, const mpq_class &op2) {
+    template <typename T> inline friend NON_MPQ_COND(T, mpq_class) operator/(const T op1, const mpq_class &op2) {
         mpq_class result(op1);
         mpq_div(result.value, result.value, op2.value);
         return result;
@@ -1757,11 +2400,85 @@ inline mpq_class operator/(const mpq_class &op1, const mpq_class &op2) {
     mpq_div(result.value, op1.value, op2.value);
     return result;
 }
+// rvalue operands: the result is computed in place into an expiring temporary, so that
+// a + b + c + d allocates once instead of once per operator. The overloads are templates whose
+// parameters are all deduced and restricted to mpq_class, so that they never compete with the
+// mixed-type operators and never convert an operand into the temporary.
+template <typename U, typename T> inline EXACT_COND(U, T, mpq_class, mpq_class) operator+(U &&op1, const T &op2) {
+    mpq_add(op1.get_mpq_t(), op1.get_mpq_t(), op2.get_mpq_t());
+    return std::move(op1);
+}
+template <typename T, typename U> inline EXACT_COND(T, U, mpq_class, mpq_class) operator+(const T &op1, U &&op2) {
+    mpq_add(op2.get_mpq_t(), op1.get_mpq_t(), op2.get_mpq_t());
+    return std::move(op2);
+}
+template <typename U, typename T> inline EXACT_COND(U, T, mpq_class, mpq_class) operator+(U &&op1, T &&op2) { return std::move(op1) + op2; }
+template <typename U, typename T> inline EXACT_COND(U, T, mpq_class, mpq_class) operator-(U &&op1, const T &op2) {
+    mpq_sub(op1.get_mpq_t(), op1.get_mpq_t(), op2.get_mpq_t());
+    return std::move(op1);
+}
+template <typename T, typename U> inline EXACT_COND(T, U, mpq_class, mpq_class) operator-(const T &op1, U &&op2) {
+    mpq_sub(op2.get_mpq_t(), op1.get_mpq_t(), op2.get_mpq_t());
+    return std::move(op2);
+}
+template <typename U, typename T> inline EXACT_COND(U, T, mpq_class, mpq_class) operator-(U &&op1, T &&op2) { return std::move(op1) - op2; }
+template <typename U, typename T> inline EXACT_COND(U, T, mpq_class, mpq_class) operator*(U &&op1, const T &op2) {
+    mpq_mul(op1.get_mpq_t(), op1.get_mpq_t(), op2.get_mpq_t());
+    return std::move(op1);
+}
+template <typename T, typename U> inline EXACT_COND(T, U, mpq_class, mpq_class) operator*(const T &op1, U &&op2) {
+    mpq_mul(op2.get_mpq_t(), op1.get_mpq_t(), op2.get_mpq_t());
+    return std::move(op2);
+}
+template <typename U, typename T> inline EXACT_COND(U, T, mpq_class, mpq_class) operator*(U &&op1, T &&op2) { return std::move(op1) * op2; }
+template <typename U, typename T> inline EXACT_COND(U, T, mpq_class, mpq_class) operator/(U &&op1, const T &op2) {
+    mpq_div(op1.get_mpq_t(), op1.get_mpq_t(), op2.get_mpq_t());
+    return std::move(op1);
+}
+template <typename T, typename U> inline EXACT_COND(T, U, mpq_class, mpq_class) operator/(const T &op1, U &&op2) {
+    mpq_div(op2.get_mpq_t(), op1.get_mpq_t(), op2.get_mpq_t());
+    return std::move(op2);
+}
+template <typename U, typename T> inline EXACT_COND(U, T, mpq_class, mpq_class) operator/(U &&op1, T &&op2) { return std::move(op1) / op2; }
+inline mpq_class operator-(mpq_class &&op) {
+    mpq_neg(op.get_mpq_t(), op.get_mpq_t());
+    return std::move(op);
+}
 inline mpq_class abs(const mpq_class &op) {
     mpq_class rop(op);
     mpq_abs(rop.value, op.get_mpq_t());
     return rop;
 }
+// fused multiply-add: addmul(acc, a, b) is acc += a * b and submul(acc, a, b) is acc -= a * b,
+// the product goes to a per-thread scratch value; fma(a, b, c) is a * b + c and fms(a, b, c) is a * b - c
+inline mpq_ptr mpq_scratch() {
+    static thread_local mpq_class scratch;
+    return scratch.get_mpq_t();
+}
+inline mpq_class &addmul(mpq_class &acc, const mpq_class &a, const mpq_class &b) {
+    mpq_ptr t = mpq_scratch();
+    mpq_mul(t, a.get_mpq_t(), b.get_mpq_t());
+    mpq_add(acc.get_mpq_t(), acc.get_mpq_t(), t);
+    return acc;
+}
+inline mpq_class &submul(mpq_class &acc, const mpq_class &a, const mpq_class &b) {
+    mpq_ptr t = mpq_scratch();
+    mpq_mul(t, a.get_mpq_t(), b.get_mpq_t());
+    mpq_sub(acc.get_mpq_t(), acc.get_mpq_t(), t);
+    return acc;
+}
+inline mpq_class fma(const mpq_class &a, const mpq_class &b, const mpq_class &c) {
+    mpq_class rop;
+    mpq_mul(rop.get_mpq_t(), a.get_mpq_t(), b.get_mpq_t());
+    mpq_add(rop.get_mpq_t(), rop.get_mpq_t(), c.get_mpq_t());
+    return rop;
+}
+inline mpq_class fms(const mpq_class &a, const mpq_class &b, const mpq_class &c) {
+    mpq_class rop;
+    mpq_mul(rop.get_mpq_t(), a.get_mpq_t(), b.get_mpq_t());
+    mpq_sub(rop.get_mpq_t(), rop.get_mpq_t(), c.get_mpq_t());
+    return rop;
+}
 inline void print_mpq(std::ostream &os, const mpq_t op) {
     std::ios_base::fmtflags flags = os.flags();
     std::streamsize width = os.width();
@@ -2047,25 +2764,40 @@ class mpf_class {
     // The rule 2 of 5 copy assignment operator
     mpf_class &operator=(const mpf_class &op) noexcept {
         if (this != &op) {
-            mpf_set(value, op.value);
+            mpf_set(get_mpf_t(), op.value);
         }
         return *this;
     }
     // The rule 3 of 5 default deconstructor
-    ~mpf_class() { mpf_clear(value); }
+    ~mpf_class() {
+        if (value->_mp_d != nullptr)
+            mpf_clear(value);
+    }
     // The rule 4 of 5 move constructor
+    // Takes over the limbs of op and leaves it empty (no limbs, reads as zero, keeps its precision),
+    // so that moving never allocates. An empty object gets its limbs back on the first write.
     mpf_class(mpf_class &&op) noexcept {
-        mpf_init(value);
-        mpf_swap(value, op.value);
+        *value = *op.value;
+        op.value->_mp_d = nullptr;
+        op.value->_mp_size = 0;
+        op.value->_mp_exp = 0;
     }
     // The rule 5 of 5 move assignment operator
+    // Swaps when the precisions agree or gmpxx_defaults::move_policy is prec_policy::adopt_source,
+    // and copies the value into this precision otherwise.
     mpf_class &operator=(mpf_class &&op) noexcept {
         if (this != &op) {
 #if !defined ___GMPXX_MKII_NOPRECCHANGE___
-            if (mpf_get_prec(this->get_mpf_t()) == mpf_get_prec(op.value)) {
+            if (mpf_get_prec(value) == mpf_get_prec(op.value) || gmpxx_defaults::move_policy == prec_policy::adopt_source) {
                 mpf_swap(value, op.value);
+#if defined ___GMPXX_MKII_MOVE_STATS___
+                move_stats.swaps++;
+#endif
             } else {
-                mpf_set(value, op.value);
+                mpf_set(get_mpf_t(), op.value);
+#if defined ___GMPXX_MKII_MOVE_STATS___
+                move_stats.copies++;
+#endif
             }
 #else
             mpf_swap(value, op.value);
@@ -2152,60 +2884,60 @@ class mpf_class {
 
     // assignments from other objects
     mpf_class &operator=(double d) noexcept {
-        mpf_set_d(value, d);
+        mpf_set_d(get_mpf_t(), d);
         return *this;
     }
     mpf_class &operator=(unsigned long int d) noexcept {
-        mpf_set_ui(value, d);
+        mpf_set_ui(get_mpf_t(), d);
         return *this;
     }
     mpf_class &operator=(signed long int d) noexcept {
-        mpf_set_si(value, d);
+        mpf_set_si(get_mpf_t(), d);
         return *this;
     }
     mpf_class &operator=(unsigned int d) noexcept {
-        mpf_set_ui(value, static_cast<unsigned long int>(d));
+        mpf_set_ui(get_mpf_t(), static_cast<unsigned long int>(d));
         return *this;
     }
     mpf_class &operator=(signed int d) noexcept {
-        mpf_set_si(value, static_cast<signed long int>(d));
+        mpf_set_si(get_mpf_t(), static_cast<signed long int>(d));
         return *this;
     }
     mpf_class &operator=(const char *str) {
-        if (mpf_set_str(value, str, gmpxx_defaults::base) != 0) {
+        if (mpf_set_str(get_mpf_t(), str, gmpxx_defaults::base) != 0) {
             throw std::invalid_argument("");
         }
         return *this;
     }
     mpf_class &operator=(const std::string &str) {
-        if (mpf_set_str(value, str.c_str(), gmpxx_defaults::base) != 0) {
+        if (mpf_set_str(get_mpf_t(), str.c_str(), gmpxx_defaults::base) != 0) {
             throw std::invalid_argument("");
         }
         return *this;
     }
     // operators
     inline mpf_class &operator++() {
-        mpf_add_ui(value, value, 1);
+        mpf_add_ui(get_mpf_t(), value, 1);
         return *this;
     }
     inline mpf_class &operator--() {
-        mpf_sub_ui(value, value, 1);
+        mpf_sub_ui(get_mpf_t(), value, 1);
         return *this;
     }
     inline mpf_class operator++(int) {
-        mpf_add_ui(value, value, 1);
+        mpf_add_ui(get_mpf_t(), value, 1);
         return *this;
     }
     inline mpf_class operator--(int) {
-        mpf_sub_ui(value, value, 1);
+        mpf_sub_ui(get_mpf_t(), value, 1);
         return *this;
     }
     template <typename T> INT_COND(T, mpf_class &) operator<<=(T n) {
-        mpf_mul_2exp(value, value, static_cast<mp_bitcnt_t>(n));
+        mpf_mul_2exp(get_mpf_t(), value, static_cast<mp_bitcnt_t>(n));
         return *this;
     }
     template <typename T> INT_COND(T, mpf_class &) operator>>=(T n) {
-        mpf_div_2exp(value, value, static_cast<mp_bitcnt_t>(n));
+        mpf_div_2exp(get_mpf_t(), value, static_cast<mp_bitcnt_t>(n));
         return *this;
     }
     template <typename T> friend INT_COND(T, mpf_class) operator<<(const mpf_class &op1, T op2) {
@@ -2228,7 +2960,9 @@ class mpf_class {
     inline friend mpf_class operator-(const mpf_class &op);
     inline friend mpf_class operator+(const mpf_class &op1, const mpf_class &op2);
     inline friend mpf_class operator-(const mpf_class &op1, const mpf_class &op2);
+#if !defined ___GMPXX_MKII_EXPRESSION_TEMPLATES___
     inline friend mpf_class operator*(const mpf_class &op1, const mpf_class &op2);
+#endif
     inline friend mpf_class operator/(const mpf_class &op1, const mpf_class &op2);
 
     inline friend mpf_class &operator+=(mpf_class &lhs, const mpz_class &rhs);
@@ -2427,8 +3161,8 @@ class mpf_class {
     }
     // int mpf_class::set_str (const char *str, int base)
     // int mpf_class::set_str (const string& str, int base)
-    int set_str(const char *str, int base) { return mpf_set_str(value, str, base); }
-    int set_str(const std::string &str, int base) { return mpf_set_str(value, str.c_str(), base); }
+    int set_str(const char *str, int base) { return mpf_set_str(get_mpf_t(), str, base); }
+    int set_str(const std::string &str, int base) { return mpf_set_str(get_mpf_t(), str.c_str(), base); }
 
     // int sgn (mpf_class op)
     // mpf_class sqrt (mpf_class op)
@@ -2448,8 +3182,8 @@ class mpf_class {
     // void mpf_class::set_prec (mp_bitcnt_t prec)
     // void mpf_class::set_prec_raw (mp_bitcnt_t prec)
     mp_bitcnt_t get_prec() const { return mpf_get_prec(value); }
-    void set_prec(mp_bitcnt_t prec) { mpf_set_prec(value, prec); }
-    void set_prec_raw(mp_bitcnt_t prec) { mpf_set_prec_raw(value, prec); }
+    void set_prec(mp_bitcnt_t prec) { mpf_set_prec(get_mpf_t(), prec); }
+    void set_prec_raw(mp_bitcnt_t prec) { mpf_set_prec_raw(get_mpf_t(), prec); }
 
     friend std::ostream &operator<<(std::ostream &os, const mpf_class &op);
     friend std::ostream &operator<<(std::ostream &os, const mpf_t op);
@@ -2470,16 +3204,25 @@ class mpf_class {
     operator mpq_class() const;
     operator mpz_class() const;
     mpf_class &operator=(const mpz_class &other) {
-        mpf_set_z(this->value, other.get_mpz_t());
+        mpf_set_z(get_mpf_t(), other.get_mpz_t());
         return *this;
     }
     mpf_class &operator=(const mpq_class &other) {
-        mpf_set_q(this->value, other.get_mpq_t());
+        mpf_set_q(get_mpf_t(), other.get_mpq_t());
         return *this;
     }
+#if defined ___GMPXX_MKII_EXPRESSION_TEMPLATES___
+    mpf_class &operator=(const mpf_mul_expr &e);
+    mpf_class &operator=(const mpf_mul_add_expr &e);
+    mpf_class &operator=(const mpf_mul_plus_expr &e);
+#endif
 
     mpf_srcptr get_mpf_t() const { return value; }
-    mpf_ptr get_mpf_t() { return value; }
+    mpf_ptr get_mpf_t() {
+        if (value->_mp_d == nullptr) // moved-from
+            mpf_init2(value, mpf_get_prec(value));
+        return value;
+    }
 
   private:
     mpf_t value;
@@ -2504,19 +3247,19 @@ inline int preccmp(const mpf_class &op1, const mpf_class &op2) {
     }
 }
 inline mpf_class &operator+=(mpf_class &lhs, const mpf_class &rhs) {
-    mpf_add(lhs.value, lhs.value, rhs.value);
+    mpf_add(lhs.get_mpf_t(), lhs.value, rhs.value);
     return lhs;
 }
 inline mpf_class &operator-=(mpf_class &lhs, const mpf_class &rhs) {
-    mpf_sub(lhs.value, lhs.value, rhs.value);
+    mpf_sub(lhs.get_mpf_t(), lhs.value, rhs.value);
     return lhs;
 }
 inline mpf_class &operator*=(mpf_class &lhs, const mpf_class &rhs) {
-    mpf_mul(lhs.value, lhs.value, rhs.value);
+    mpf_mul(lhs.get_mpf_t(), lhs.value, rhs.value);
     return lhs;
 }
 inline mpf_class &operator/=(mpf_class &lhs, const mpf_class &rhs) {
-    mpf_div(lhs.value, lhs.value, rhs.value);
+    mpf_div(lhs.get_mpf_t(), lhs.value, rhs.value);
     return lhs;
 }
 inline mpf_class operator+(const mpf_class &op1, const mpf_class &op2) {
@@ -2547,6 +3290,7 @@ inline mpf_class operator-(const mpf_class &op1, const mpf_class &op2) {
     }
 #endif
 }
+#if !defined ___GMPXX_MKII_EXPRESSION_TEMPLATES___
 inline mpf_class operator*(const mpf_class &op1, const mpf_class &op2) {
 #if !defined ___GMPXX_MKII_NOPRECCHANGE___
     mp_bitcnt_t max_prec = std::max(op1.get_prec(), op2.get_prec());
@@ -2557,6 +3301,7 @@ inline mpf_class operator*(const mpf_class &op1, const mpf_class &op2) {
     mpf_mul(result.get_mpf_t(), op1.get_mpf_t(), op2.get_mpf_t());
     return result;
 }
+#endif
 inline mpf_class operator/(const mpf_class &op1, const mpf_class &op2) {
 #if defined ___GMPXX_MKII_NOPRECCHANGE___
     mpf_class result(op1);
@@ -2584,6 +3329,395 @@ inline mpf_class operator-(const mpf_class &op) {
     mpf_neg(result.value, op.value);
     return result;
 }
+// rvalue operands: the result is computed in place into an expiring temporary when its
+// precision is the one the operators above would give the result, so that a + b + c + d
+// allocates once instead of once per operator. The overloads are templates whose parameters
+// are all deduced and restricted to mpf_class, so that they never compete with the mixed-type
+// operators and never convert an operand into the temporary.
+inline bool mpf_reusable(const mpf_class &tmp, const mpf_class &other) {
+#if defined ___GMPXX_MKII_NOPRECCHANGE___
+    return tmp.get_prec() == mpf_get_default_prec() && other.get_prec() == mpf_get_default_prec();
+#else
+    return tmp.get_prec() >= other.get_prec();
+#endif
+}
+template <typename U, typename T> inline EXACT_COND(U, T, mpf_class, mpf_class) operator+(U &&op1, const T &op2) {
+    if (!mpf_reusable(op1, op2))
+        return op1 + op2;
+    mpf_add(op1.get_mpf_t(), op1.get_mpf_t(), op2.get_mpf_t());
+    return std::move(op1);
+}
+template <typename T, typename U> inline EXACT_COND(T, U, mpf_class, mpf_class) operator+(const T &op1, U &&op2) {
+    if (!mpf_reusable(op2, op1))
+        return op1 + op2;
+    mpf_add(op2.get_mpf_t(), op1.get_mpf_t(), op2.get_mpf_t());
+    return std::move(op2);
+}
+template <typename U, typename T> inline EXACT_COND(U, T, mpf_class, mpf_class) operator+(U &&op1, T &&op2) { return std::move(op1) + op2; }
+template <typename U, typename T> inline EXACT_COND(U, T, mpf_class, mpf_class) operator-(U &&op1, const T &op2) {
+    if (!mpf_reusable(op1, op2))
+        return op1 - op2;
+    mpf_sub(op1.get_mpf_t(), op1.get_mpf_t(), op2.get_mpf_t());
+    return std::move(op1);
+}
+template <typename T, typename U> inline EXACT_COND(T, U, mpf_class, mpf_class) operator-(const T &op1, U &&op2) {
+    if (!mpf_reusable(op2, op1))
+        return op1 - op2;
+    mpf_sub(op2.get_mpf_t(), op1.get_mpf_t(), op2.get_mpf_t());
+    return std::move(op2);
+}
+template <typename U, typename T> inline EXACT_COND(U, T, mpf_class, mpf_class) operator-(U &&op1, T &&op2) { return std::move(op1) - op2; }
+template <typename U, typename T> inline EXACT_COND(U, T, mpf_class, mpf_class) operator*(U &&op1, const T &op2) {
+    if (!mpf_reusable(op1, op2))
+        return op1 * op2;
+    mpf_mul(op1.get_mpf_t(), op1.get_mpf_t(), op2.get_mpf_t());
+    return std::move(op1);
+}
+template <typename T, typename U> inline EXACT_COND(T, U, mpf_class, mpf_class) operator*(const T &op1, U &&op2) {
+    if (!mpf_reusable(op2, op1))
+        return op1 * op2;
+    mpf_mul(op2.get_mpf_t(), op1.get_mpf_t(), op2.get_mpf_t());
+    return std::move(op2);
+}
+template <typename U, typename T> inline EXACT_COND(U, T, mpf_class, mpf_class) operator*(U &&op1, T &&op2) { return std::move(op1) * op2; }
+template <typename U, typename T> inline EXACT_COND(U, T, mpf_class, mpf_class) operator/(U &&op1, const T &op2) {
+    if (!mpf_reusable(op1, op2))
+        return op1 / op2;
+    mpf_div(op1.get_mpf_t(), op1.get_mpf_t(), op2.get_mpf_t());
+    return std::move(op1);
+}
+template <typename T, typename U> inline EXACT_COND(T, U, mpf_class, mpf_class) operator/(const T &op1, U &&op2) {
+    if (!mpf_reusable(op2, op1))
+        return op1 / op2;
+    mpf_div(op2.get_mpf_t(), op1.get_mpf_t(), op2.get_mpf_t());
+    return std::move(op2);
+}
+template <typename U, typename T> inline EXACT_COND(U, T, mpf_class, mpf_class) operator/(U &&op1, T &&op2) { return std::move(op1) / op2; }
+inline mpf_class operator-(mpf_class &&op) {
+    mpf_neg(op.get_mpf_t(), op.get_mpf_t());
+    return std::move(op);
+}
+// precision of the result of a binary operator on operands of precisions prec1 and prec2
+inline mp_bitcnt_t mpf_binary_prec(mp_bitcnt_t prec1, mp_bitcnt_t prec2) {
+#if defined ___GMPXX_MKII_NOPRECCHANGE___
+    (void)prec1;
+    (void)prec2;
+    return mpf_get_default_prec();
+#else
+    return std::max(prec1, prec2);
+#endif
+}
+// per-thread scratch value for fused operations; the contents do not survive the next call
+inline mpf_ptr mpf_scratch(mp_bitcnt_t prec) {
+    static thread_local mpf_class scratch(0, prec);
+    if (scratch.get_prec() != prec)
+        scratch.set_prec(prec);
+    return scratch.get_mpf_t();
+}
+
+// fused multiply-add: addmul(acc, a, b) is acc += a * b and submul(acc, a, b) is acc -= a * b
+// without a temporary: the product goes to the scratch value with the precision a * b would have.
+// fma(a, b, c) is a * b + c and fms(a, b, c) is a * b - c.
+inline mpf_class &addmul(mpf_class &acc, const mpf_class &a, const mpf_class &b) {
+    mpf_ptr t = mpf_scratch(mpf_binary_prec(a.get_prec(), b.get_prec()));
+    mpf_mul(t, a.get_mpf_t(), b.get_mpf_t());
+    mpf_add(acc.get_mpf_t(), acc.get_mpf_t(), t);
+    return acc;
+}
+inline mpf_class &submul(mpf_class &acc, const mpf_class &a, const mpf_class &b) {
+    mpf_ptr t = mpf_scratch(mpf_binary_prec(a.get_prec(), b.get_prec()));
+    mpf_mul(t, a.get_mpf_t(), b.get_mpf_t());
+    mpf_sub(acc.get_mpf_t(), acc.get_mpf_t(), t);
+    return acc;
+}
+inline mpf_class &addmul_ui(mpf_class &acc, const mpf_class &a, unsigned long int b) {
+    mpf_ptr t = mpf_scratch(mpf_binary_prec(a.get_prec(), a.get_prec()));
+    mpf_mul_ui(t, a.get_mpf_t(), b);
+    mpf_add(acc.get_mpf_t(), acc.get_mpf_t(), t);
+    return acc;
+}
+inline mpf_class &submul_ui(mpf_class &acc, const mpf_class &a, unsigned long int b) {
+    mpf_ptr t = mpf_scratch(mpf_binary_prec(a.get_prec(), a.get_prec()));
+    mpf_mul_ui(t, a.get_mpf_t(), b);
+    mpf_sub(acc.get_mpf_t(), acc.get_mpf_t(), t);
+    return acc;
+}
+template <typename T> inline UNSIGNED_INT_COND(T, mpf_class &) addmul(mpf_class &acc, const mpf_class &a, const T b) { return addmul_ui(acc, a, static_cast<unsigned long int>(b)); }
+template <typename T> inline UNSIGNED_INT_COND(T, mpf_class &) submul(mpf_class &acc, const mpf_class &a, const T b) { return submul_ui(acc, a, static_cast<unsigned long int>(b)); }
+template <typename T> inline SIGNED_INT_COND(T, mpf_class &) addmul(mpf_class &acc, const mpf_class &a, const T b) {
+    if (b >= 0)
+        return addmul_ui(acc, a, static_cast<unsigned long int>(b));
+    return submul_ui(acc, a, 0UL - static_cast<unsigned long int>(b));
+}
+template <typename T> inline SIGNED_INT_COND(T, mpf_class &) submul(mpf_class &acc, const mpf_class &a, const T b) {
+    if (b >= 0)
+        return submul_ui(acc, a, static_cast<unsigned long int>(b));
+    return addmul_ui(acc, a, 0UL - static_cast<unsigned long int>(b));
+}
+// a double is exact in 64 bits, so only the product is rounded
+inline mpf_srcptr mpf_scratch_d(double op) {
+    static thread_local mpf_class scratch(0, 64);
+    mpf_set_d(scratch.get_mpf_t(), op);
+    return scratch.get_mpf_t();
+}
+template <typename T> inline NON_INT_COND(T, mpf_class &) addmul(mpf_class &acc, const mpf_class &a, const T b) {
+    mpf_srcptr _b = mpf_scratch_d(static_cast<double>(b));
+    mpf_ptr t = mpf_scratch(mpf_binary_prec(a.get_prec(), a.get_prec()));
+    mpf_mul(t, a.get_mpf_t(), _b);
+    mpf_add(acc.get_mpf_t(), acc.get_mpf_t(), t);
+    return acc;
+}
+template <typename T> inline NON_INT_COND(T, mpf_class &) submul(mpf_class &acc, const mpf_class &a, const T b) {
+    mpf_srcptr _b = mpf_scratch_d(static_cast<double>(b));
+    mpf_ptr t = mpf_scratch(mpf_binary_prec(a.get_prec(), a.get_prec()));
+    mpf_mul(t, a.get_mpf_t(), _b);
+    mpf_sub(acc.get_mpf_t(), acc.get_mpf_t(), t);
+    return acc;
+}
+inline mpf_class fma(const mpf_class &a, const mpf_class &b, const mpf_class &c) {
+    mpf_class rop(0, mpf_binary_prec(mpf_binary_prec(a.get_prec(), b.get_prec()), c.get_prec()));
+    mpf_mul(rop.get_mpf_t(), a.get_mpf_t(), b.get_mpf_t());
+    mpf_add(rop.get_mpf_t(), rop.get_mpf_t(), c.get_mpf_t());
+    return rop;
+}
+inline mpf_class fms(const mpf_class &a, const mpf_class &b, const mpf_class &c) {
+    mpf_class rop(0, mpf_binary_prec(mpf_binary_prec(a.get_prec(), b.get_prec()), c.get_prec()));
+    mpf_mul(rop.get_mpf_t(), a.get_mpf_t(), b.get_mpf_t());
+    mpf_sub(rop.get_mpf_t(), rop.get_mpf_t(), c.get_mpf_t());
+    return rop;
+}
+// Exact accumulator (Kulisch-style) for sums of mpf_class values and products. Every term is
+// added without rounding into a two's complement fixed-point number held in limbs, whose
+// least significant limb has the weight 2^(GMP_NUMB_BITS * lsb); the window grows at either end
+// as terms need it. get(prec) rounds (truncates, as mpf does) once. The sum is exact, so it does
+// not depend on the order of the terms, and partial accumulators merged with += give the same
+// bits for any split of the terms, e.g. over OpenMP threads.
+class mpf_exact_accumulator {
+  public:
+    void clear() {
+        limbs.clear();
+        lsb = 0;
+    }
+    mpf_exact_accumulator &add(const mpf_class &a) {
+        mpf_srcptr _a = a.get_mpf_t();
+        mp_size_t n = std::abs(_a->_mp_size);
+        add_limbs(_a->_mp_d, n, _a->_mp_exp - n, _a->_mp_size < 0);
+        return *this;
+    }
+    mpf_exact_accumulator &sub(const mpf_class &a) {
+        mpf_srcptr _a = a.get_mpf_t();
+        mp_size_t n = std::abs(_a->_mp_size);
+        add_limbs(_a->_mp_d, n, _a->_mp_exp - n, _a->_mp_size > 0);
+        return *this;
+    }
+    mpf_exact_accumulator &addmul(const mpf_class &a, const mpf_class &b) { return add_product(a.get_mpf_t(), b.get_mpf_t(), false); }
+    mpf_exact_accumulator &submul(const mpf_class &a, const mpf_class &b) { return add_product(a.get_mpf_t(), b.get_mpf_t(), true); }
+    mpf_exact_accumulator &operator+=(const mpf_exact_accumulator &op) {
+        bool negative;
+        std::vector<mp_limb_t> m = op.magnitude(negative);
+        add_limbs(m.data(), static_cast<mp_size_t>(m.size()), op.lsb, negative);
+        return *this;
+    }
+    // the sum truncated to prec bits
+    mpf_class get(mp_bitcnt_t prec = mpf_get_default_prec()) const {
+        mpf_class result(0, prec);
+        bool negative;
+        std::vector<mp_limb_t> m = magnitude(negative);
+        if (m.empty())
+            return result;
+        mpz_t z;
+        mpz_roinit_n(z, m.data(), negative ? -static_cast<mp_size_t>(m.size()) : static_cast<mp_size_t>(m.size()));
+        mpf_set_z(result.get_mpf_t(), z);
+        if (lsb > 0)
+            mpf_mul_2exp(result.get_mpf_t(), result.get_mpf_t(), static_cast<mp_bitcnt_t>(lsb) * GMP_NUMB_BITS);
+        else if (lsb < 0)
+            mpf_div_2exp(result.get_mpf_t(), result.get_mpf_t(), static_cast<mp_bitcnt_t>(-lsb) * GMP_NUMB_BITS);
+        return result;
+    }
+
+  private:
+    static mp_limb_t sign_extension(mp_limb_t limb) { return (limb >> (GMP_NUMB_BITS - 1)) ? ~static_cast<mp_limb_t>(0) : 0; }
+    mpf_exact_accumulator &add_product(mpf_srcptr a, mpf_srcptr b, bool negate) {
+        mp_size_t na = std::abs(a->_mp_size), nb = std::abs(b->_mp_size);
+        if (na == 0 || nb == 0)
+            return *this;
+        product.resize(na + nb);
+        if (na >= nb)
+            mpn_mul(product.data(), a->_mp_d, na, b->_mp_d, nb);
+        else
+            mpn_mul(product.data(), b->_mp_d, nb, a->_mp_d, na);
+        add_limbs(product.data(), na + nb, (a->_mp_exp - na) + (b->_mp_exp - nb), ((a->_mp_size < 0) != (b->_mp_size < 0)) != negate);
+        return *this;
+    }
+    // adds (or subtracts) the n-limb magnitude p times 2^(GMP_NUMB_BITS * exp); the top limb is kept
+    // a pure sign extension, so the term fits below it and the sum cannot overflow the window
+    void add_limbs(const mp_limb_t *p, mp_size_t n, mp_exp_t exp, bool negative) {
+        if (n == 0)
+            return;
+        if (limbs.empty()) {
+            lsb = exp;
+            limbs.assign(n + 1, 0);
+        } else if (exp < lsb) {
+            limbs.insert(limbs.begin(), lsb - exp, 0);
+            lsb = exp;
+        }
+        mp_size_t off = exp - lsb;
+        if (static_cast<mp_size_t>(limbs.size()) < off + n + 1)
+            limbs.resize(off + n + 1, sign_extension(limbs.back()));
+        mp_limb_t *r = limbs.data() + off;
+        mp_size_t rn = static_cast<mp_size_t>(limbs.size()) - off;
+        if (negative)
+            mpn_sub(r, r, rn, p, n);
+        else
+            mpn_add(r, r, rn, p, n);
+        if (limbs.back() != sign_extension(limbs[limbs.size() - 2]))
+            limbs.push_back(sign_extension(limbs.back()));
+    }
+    // absolute value without high zero limbs, and its sign
+    std::vector<mp_limb_t> magnitude(bool &negative) const {
+        std::vector<mp_limb_t> m(limbs);
+        negative = !m.empty() && sign_extension(m.back()) != 0;
+        if (negative)
+            mpn_neg(m.data(), m.data(), static_cast<mp_size_t>(m.size()));
+        while (!m.empty() && m.back() == 0)
+            m.pop_back();
+        return m;
+    }
+    std::vector<mp_limb_t> limbs;
+    mp_exp_t lsb = 0;
+    std::vector<mp_limb_t> product;
+};
+#if defined ___GMPXX_MKII_EXPRESSION_TEMPLATES___
+// Expression templates (___GMPXX_MKII_EXPRESSION_TEMPLATES___): the product of two mpf_class
+// lvalues is recorded as an mpf_mul_expr instead of being evaluated, so that a = b*c,
+// a += b*c, a -= b*c, a = b*c + d*e and a = alpha*x + y are evaluated directly into a with at
+// most one (thread-local) scratch value. Any other use converts the expression to mpf_class,
+// which evaluates it eagerly with the precision the operators above would give. Expressions
+// refer to their operands, so they must not be kept beyond the full-expression (e.g. by auto).
+template <> struct is_mpf_expr<mpf_mul_expr> : std::true_type {};
+template <> struct is_mpf_expr<mpf_mul_add_expr> : std::true_type {};
+template <> struct is_mpf_expr<mpf_mul_plus_expr> : std::true_type {};
+#define MPF_EXPR_COND(E, X) typename std::enable_if<is_mpf_expr<E>::value, X>::type
+#define MPF_EXPR_NON_EXPR_COND(E, T, X) typename std::enable_if<is_mpf_expr<E>::value && !is_mpf_expr<T>::value, X>::type
+
+class mpf_mul_expr {
+  public:
+    mpf_mul_expr(const mpf_class &op1, const mpf_class &op2) : op1(op1), op2(op2) {}
+    mp_bitcnt_t get_prec() const { return mpf_binary_prec(op1.get_prec(), op2.get_prec()); }
+    void eval(mpf_ptr rop) const { mpf_mul(rop, op1.get_mpf_t(), op2.get_mpf_t()); }
+    operator mpf_class() const {
+        mpf_class result(0, get_prec());
+        eval(result.get_mpf_t());
+        return result;
+    }
+
+  private:
+    const mpf_class &op1;
+    const mpf_class &op2;
+};
+// op1 + op2; op2 goes to the scratch value first, so rop may alias any operand
+class mpf_mul_add_expr {
+  public:
+    mpf_mul_add_expr(const mpf_mul_expr &op1, const mpf_mul_expr &op2) : op1(op1), op2(op2) {}
+    mp_bitcnt_t get_prec() const { return mpf_binary_prec(op1.get_prec(), op2.get_prec()); }
+    void eval(mpf_ptr rop) const {
+        mpf_ptr t = mpf_scratch(op2.get_prec());
+        op2.eval(t);
+        op1.eval(rop);
+        mpf_add(rop, rop, t);
+    }
+    operator mpf_class() const {
+        mpf_class result(0, get_prec());
+        eval(result.get_mpf_t());
+        return result;
+    }
+
+  private:
+    mpf_mul_expr op1;
+    mpf_mul_expr op2;
+};
+// op1 + op2 with a product op1
+class mpf_mul_plus_expr {
+  public:
+    mpf_mul_plus_expr(const mpf_mul_expr &op1, const mpf_class &op2) : op1(op1), op2(op2) {}
+    mp_bitcnt_t get_prec() const { return mpf_binary_prec(op1.get_prec(), op2.get_prec()); }
+    void eval(mpf_ptr rop) const {
+        mpf_ptr t = mpf_scratch(op1.get_prec());
+        op1.eval(t);
+        mpf_add(rop, t, op2.get_mpf_t());
+    }
+    operator mpf_class() const {
+        mpf_class result(0, get_prec());
+        eval(result.get_mpf_t());
+        return result;
+    }
+
+  private:
+    mpf_mul_expr op1;
+    const mpf_class &op2;
+};
+
+inline mpf_mul_expr operator*(const mpf_class &op1, const mpf_class &op2) { return mpf_mul_expr(op1, op2); }
+inline mpf_mul_add_expr operator+(const mpf_mul_expr &op1, const mpf_mul_expr &op2) { return mpf_mul_add_expr(op1, op2); }
+inline mpf_mul_plus_expr operator+(const mpf_mul_expr &op1, const mpf_class &op2) { return mpf_mul_plus_expr(op1, op2); }
+inline mpf_mul_plus_expr operator+(const mpf_class &op1, const mpf_mul_expr &op2) { return mpf_mul_plus_expr(op2, op1); }
+
+inline mpf_class &mpf_class::operator=(const mpf_mul_expr &e) {
+    e.eval(get_mpf_t());
+    return *this;
+}
+inline mpf_class &mpf_class::operator=(const mpf_mul_add_expr &e) {
+    e.eval(get_mpf_t());
+    return *this;
+}
+inline mpf_class &mpf_class::operator=(const mpf_mul_plus_expr &e) {
+    e.eval(get_mpf_t());
+    return *this;
+}
+inline mpf_class &operator+=(mpf_class &lhs, const mpf_mul_expr &rhs) {
+    mpf_ptr t = mpf_scratch(rhs.get_prec());
+    rhs.eval(t);
+    mpf_add(lhs.get_mpf_t(), lhs.get_mpf_t(), t);
+    return lhs;
+}
+inline mpf_class &operator-=(mpf_class &lhs, const mpf_mul_expr &rhs) {
+    mpf_ptr t = mpf_scratch(rhs.get_prec());
+    rhs.eval(t);
+    mpf_sub(lhs.get_mpf_t(), lhs.get_mpf_t(), t);
+    return lhs;
+}
+
+// everything else evaluates the expression first
+template <typename E> inline MPF_EXPR_COND(E, mpf_class) operator-(const E &op) { return -mpf_class(op); }
+template <typename E, typename T> inline MPF_EXPR_COND(E, mpf_class) operator+(const E &op1, const T &op2) { return mpf_class(op1) + op2; }
+template <typename T, typename E> inline MPF_EXPR_NON_EXPR_COND(E, T, mpf_class) operator+(const T &op1, const E &op2) { return op1 + mpf_class(op2); }
+template <typename E, typename T> inline MPF_EXPR_COND(E, mpf_class) operator-(const E &op1, const T &op2) { return mpf_class(op1) - op2; }
+template <typename T, typename E> inline MPF_EXPR_NON_EXPR_COND(E, T, mpf_class) operator-(const T &op1, const E &op2) { return op1 - mpf_class(op2); }
+template <typename E, typename T> inline MPF_EXPR_COND(E, mpf_class) operator*(const E &op1, const T &op2) { return mpf_class(op1) * op2; }
+template <typename T, typename E> inline MPF_EXPR_NON_EXPR_COND(E, T, mpf_class) operator*(const T &op1, const E &op2) { return op1 * mpf_class(op2); }
+template <typename E, typename T> inline MPF_EXPR_COND(E, mpf_class) operator/(const E &op1, const T &op2) { return mpf_class(op1) / op2; }
+template <typename T, typename E> inline MPF_EXPR_NON_EXPR_COND(E, T, mpf_class) operator/(const T &op1, const E &op2) { return op1 / mpf_class(op2); }
+template <typename E> inline MPF_EXPR_COND(E, mpf_class) operator+(const E &op1, mpf_class &&op2) { return mpf_class(op1) + std::move(op2); }
+template <typename E> inline MPF_EXPR_COND(E, mpf_class) operator+(mpf_class &&op1, const E &op2) { return std::move(op1) + mpf_class(op2); }
+template <typename E> inline MPF_EXPR_COND(E, mpf_class) operator-(const E &op1, mpf_class &&op2) { return mpf_class(op1) - std::move(op2); }
+template <typename E> inline MPF_EXPR_COND(E, mpf_class) operator-(mpf_class &&op1, const E &op2) { return std::move(op1) - mpf_class(op2); }
+template <typename E> inline MPF_EXPR_COND(E, mpf_class) operator*(const E &op1, mpf_class &&op2) { return mpf_class(op1) * std::move(op2); }
+template <typename E> inline MPF_EXPR_COND(E, mpf_class) operator*(mpf_class &&op1, const E &op2) { return std::move(op1) * mpf_class(op2); }
+template <typename E> inline MPF_EXPR_COND(E, mpf_class) operator/(const E &op1, mpf_class &&op2) { return mpf_class(op1) / std::move(op2); }
+template <typename E> inline MPF_EXPR_COND(E, mpf_class) operator/(mpf_class &&op1, const E &op2) { return std::move(op1) / mpf_class(op2); }
+template <typename E, typename T> inline MPF_EXPR_COND(E, bool) operator==(const E &op1, const T &op2) { return mpf_class(op1) == op2; }
+template <typename T, typename E> inline MPF_EXPR_NON_EXPR_COND(E, T, bool) operator==(const T &op1, const E &op2) { return op1 == mpf_class(op2); }
+template <typename E, typename T> inline MPF_EXPR_COND(E, bool) operator!=(const E &op1, const T &op2) { return mpf_class(op1) != op2; }
+template <typename T, typename E> inline MPF_EXPR_NON_EXPR_COND(E, T, bool) operator!=(const T &op1, const E &op2) { return op1 != mpf_class(op2); }
+template <typename E, typename T> inline MPF_EXPR_COND(E, bool) operator<(const E &op1, const T &op2) { return mpf_class(op1) < op2; }
+template <typename T, typename E> inline MPF_EXPR_NON_EXPR_COND(E, T, bool) operator<(const T &op1, const E &op2) { return op1 < mpf_class(op2); }
+template <typename E, typename T> inline MPF_EXPR_COND(E, bool) operator>(const E &op1, const T &op2) { return mpf_class(op1) > op2; }
+template <typename T, typename E> inline MPF_EXPR_NON_EXPR_COND(E, T, bool) operator>(const T &op1, const E &op2) { return op1 > mpf_class(op2); }
+template <typename E, typename T> inline MPF_EXPR_COND(E, bool) operator<=(const E &op1, const T &op2) { return mpf_class(op1) <= op2; }
+template <typename T, typename E> inline MPF_EXPR_NON_EXPR_COND(E, T, bool) operator<=(const T &op1, const E &op2) { return op1 <= mpf_class(op2); }
+template <typename E, typename T> inline MPF_EXPR_COND(E, bool) operator>=(const E &op1, const T &op2) { return mpf_class(op1) >= op2; }
+template <typename T, typename E> inline MPF_EXPR_NON_EXPR_COND(E, T, bool) operator>=(const T &op1, const E &op2) { return op1 >= mpf_class(op2); }
+#endif
 
 // mpz_class cmp
 inline int cmp(const mpz_class &op1, const mpz_class &op2) { return mpz_cmp(op1.get_mpz_t(), op2.get_mpz_t()); }
@@ -2625,9 +3759,9 @@ template <typename T> inline NON_INT_COND(T, int) cmp(const T op1, mpf_class &op
 template <typename T> inline SIGNED_INT_COND(T, mpf_class &) operator+=(mpf_class &lhs, const T rhs) {
     mpf_class _rhs(rhs);
     if (rhs >= 0) {
-        mpf_add_ui(lhs.value, lhs.value, static_cast<unsigned long int>(rhs));
+        mpf_add_ui(lhs.get_mpf_t(), lhs.value, static_cast<unsigned long int>(rhs));
     } else {
-        mpf_sub_ui(lhs.value, lhs.value, static_cast<unsigned long int>(-rhs));
+        mpf_sub_ui(lhs.get_mpf_t(), lhs.value, static_cast<unsigned long int>(-rhs));
     }
     return lhs;
 }
@@ -2639,9 +3773,9 @@ template <typename T> inline SIGNED_INT_COND(T, mpf_class) operator+(const mpf_c
 template <typename T> inline SIGNED_INT_COND(T, mpf_class) operator+(const T op1, const mpf_class &op2) { return op2 + op1; }
 template <typename T> inline SIGNED_INT_COND(T, mpf_class &) operator-=(mpf_class &lhs, const T rhs) {
     if (rhs >= 0) {
-        mpf_sub_ui(lhs.value, lhs.value, static_cast<unsigned long int>(rhs));
+        mpf_sub_ui(lhs.get_mpf_t(), lhs.value, static_cast<unsigned long int>(rhs));
     } else {
-        mpf_add_ui(lhs.value, lhs.value, static_cast<unsigned long int>(-rhs));
+        mpf_add_ui(lhs.get_mpf_t(), lhs.value, static_cast<unsigned long int>(-rhs));
     }
     return lhs;
 }
@@ -2666,10 +3800,10 @@ template <typename T> inline SIGNED_INT_COND(T, mpf_class) operator-(const T op1
 }
 template <typename T> inline SIGNED_INT_COND(T, mpf_class &) operator*=(mpf_class &lhs, const T rhs) {
     if (rhs >= 0) {
-        mpf_mul_ui(lhs.value, lhs.value, static_cast<unsigned long int>(rhs));
+        mpf_mul_ui(lhs.get_mpf_t(), lhs.value, static_cast<unsigned long int>(rhs));
     } else {
-        mpf_mul_ui(lhs.value, lhs.value, static_cast<unsigned long int>(-rhs));
-        mpf_neg(lhs.value, lhs.value);
+        mpf_mul_ui(lhs.get_mpf_t(), lhs.value, static_cast<unsigned long int>(-rhs));
+        mpf_neg(lhs.get_mpf_t(), lhs.value);
     }
     return lhs;
 }
@@ -2686,10 +3820,10 @@ template <typename T> inline SIGNED_INT_COND(T, mpf_class) operator*(const mpf_c
 template <typename T> inline SIGNED_INT_COND(T, mpf_class) operator*(const T op1, const mpf_class &op2) { return op2 * op1; }
 template <typename T> inline SIGNED_INT_COND(T, mpf_class &) operator/=(mpf_class &lhs, const T rhs) {
     if (rhs >= 0) {
-        mpf_div_ui(lhs.value, lhs.value, static_cast<unsigned long int>(rhs));
+        mpf_div_ui(lhs.get_mpf_t(), lhs.value, static_cast<unsigned long int>(rhs));
     } else {
-        mpf_div_ui(lhs.value, lhs.value, static_cast<unsigned long int>(-rhs));
-        mpf_neg(lhs.value, lhs.value);
+        mpf_div_ui(lhs.get_mpf_t(), lhs.value, static_cast<unsigned long int>(-rhs));
+        mpf_neg(lhs.get_mpf_t(), lhs.value);
     }
     return lhs;
 }
@@ -2714,7 +3848,7 @@ template <typename T> inline SIGNED_INT_COND(T, mpf_class) operator/(const T op1
     return result;
 }
 template <typename T> inline UNSIGNED_INT_COND(T, mpf_class &) operator+=(mpf_class &lhs, const T rhs) {
-    mpf_add_ui(lhs.value, lhs.value, rhs);
+    mpf_add_ui(lhs.get_mpf_t(), lhs.value, rhs);
     return lhs;
 }
 template <typename T> inline UNSIGNED_INT_COND(T, mpf_class) operator+(const mpf_class &op1, const T op2) {
@@ -2724,7 +3858,7 @@ template <typename T> inline UNSIGNED_INT_COND(T, mpf_class) operator+(const mpf
 }
 template <typename T> inline UNSIGNED_INT_COND(T, mpf_class) operator+(const T op1, const mpf_class &op2) { return op2 + op1; }
 template <typename T> inline UNSIGNED_INT_COND(T, mpf_class &) operator-=(mpf_class &lhs, const T rhs) {
-    mpf_sub_ui(lhs.value, lhs.value, rhs);
+    mpf_sub_ui(lhs.get_mpf_t(), lhs.value, rhs);
     return lhs;
 }
 template <typename T> inline UNSIGNED_INT_COND(T, mpf_class) operator-(const mpf_class &op1, const T op2) {
@@ -2738,7 +3872,7 @@ template <typename T> inline UNSIGNED_INT_COND(T, mpf_class) operator-(const T o
     return result;
 }
 template <typename T> inline UNSIGNED_INT_COND(T, mpf_class &) operator*=(mpf_class &lhs, const T rhs) {
-    mpf_mul_ui(lhs.value, lhs.value, rhs);
+    mpf_mul_ui(lhs.get_mpf_t(), lhs.value, rhs);
     return lhs;
 }
 template <typename T> inline UNSIGNED_INT_COND(T, mpf_class) operator*(const mpf_class &op1, const T op2) {
@@ -2748,7 +3882,7 @@ template <typename T> inline UNSIGNED_INT_COND(T, mpf_class) operator*(const mpf
 }
 template <typename T> inline UNSIGNED_INT_COND(T, mpf_class) operator*(const T op1, const mpf_class &op2) { return op2 * op1; }
 template <typename T> inline UNSIGNED_INT_COND(T, mpf_class &) operator/=(mpf_class &lhs, const T rhs) {
-    mpf_div_ui(lhs.value, lhs.value, rhs);
+    mpf_div_ui(lhs.get_mpf_t(), lhs.value, rhs);
     return lhs;
 }
 template <typename T> inline UNSIGNED_INT_COND(T, mpf_class) operator/(const mpf_class &op1, const T op2) {
@@ -2763,7 +3897,7 @@ template <typename T> inline UNSIGNED_INT_COND(T, mpf_class) operator/(const T o
 }
 template <typename T> inline NON_INT_COND(T, mpf_class &) operator+=(mpf_class &lhs, const T rhs) {
     mpf_class _rhs(rhs);
-    mpf_add(lhs.value, lhs.value, _rhs.value);
+    mpf_add(lhs.get_mpf_t(), lhs.value, _rhs.value);
     return lhs;
 }
 template <typename T> inline NON_INT_COND(T, mpf_class) operator+(const mpf_class &op1, const T op2) {
@@ -2774,7 +3908,7 @@ template <typename T> inline NON_INT_COND(T, mpf_class) operator+(const mpf_clas
 template <typename T> inline NON_INT_COND(T, mpf_class) operator+(const T op1, const mpf_class &op2) { return op2 + op1; }
 template <typename T> inline NON_INT_COND(T, mpf_class &) operator-=(mpf_class &lhs, const T rhs) {
     mpf_class _rhs(rhs);
-    mpf_sub(lhs.value, lhs.value, _rhs.value);
+    mpf_sub(lhs.get_mpf_t(), lhs.value, _rhs.value);
     return lhs;
 }
 template <typename T> inline NON_INT_COND(T, mpf_class) operator-(const mpf_class &op1, const T op2) {
@@ -2789,7 +3923,7 @@ template <typename T> inline NON_INT_COND(T, mpf_class) operator-(const T op1, c
 }
 template <typename T> inline NON_INT_COND(T, mpf_class &) operator*=(mpf_class &lhs, const T rhs) {
     mpf_class _rhs(rhs);
-    mpf_mul(lhs.value, lhs.value, _rhs.value);
+    mpf_mul(lhs.get_mpf_t(), lhs.value, _rhs.value);
     return lhs;
 }
 template <typename T> inline NON_INT_COND(T, mpf_class) operator*(const mpf_class &op1, const T op2) {
@@ -2800,7 +3934,7 @@ template <typename T> inline NON_INT_COND(T, mpf_class) operator*(const mpf_clas
 template <typename T> inline NON_INT_COND(T, mpf_class) operator*(const T op1, const mpf_class &op2) { return op2 * op1; }
 template <typename T> inline NON_INT_COND(T, mpf_class &) operator/=(mpf_class &lhs, const T rhs) {
     mpf_class _rhs(rhs);
-    mpf_div(lhs.value, lhs.value, _rhs.value);
+    mpf_div(lhs.get_mpf_t(), lhs.value, _rhs.value);
     return lhs;
 }
 template <typename T> inline NON_INT_COND(T, mpf_class) operator/(const mpf_class &op1, const T op2) {
@@ -3459,173 +4593,695 @@ inline std::istream &read_mpf_from_stream(std::istream &stream, mpf_t op) {
 }
 inline std::istream &operator>>(std::istream &stream, mpf_t op) { return read_mpf_from_stream(stream, op); }
 inline std::istream &operator>>(std::istream &stream, mpf_class &op) { return read_mpf_from_stream(stream, op.get_mpf_t()); }
-inline mpf_class const_pi() {
-    static bool calculated = false;
-    static mp_bitcnt_t calculated_pi_precision = 0;
-    mp_bitcnt_t _default_prec = mpf_get_default_prec();
-    if (!calculated || (calculated && calculated_pi_precision != _default_prec)) {
-        calculated_pi_precision = mpf_get_default_prec();
-        // calculating approximate pi using arithmetic-geometric mean
-        mpf_class zero(0.0, _default_prec);
-        mpf_class quarter(0.25, _default_prec);
-        mpf_class one(1.0, _default_prec);
-        mpf_class two(2.0, _default_prec);
-        mpf_class four(4.0, _default_prec);
-        mpf_class a(one, _default_prec), b(one / sqrt(two), _default_prec), t(quarter, _default_prec), p(one, _default_prec);
-        mpf_class a_next(zero, _default_prec), b_next(zero, _default_prec), t_next(zero, _default_prec), tmp_pi(zero, _default_prec), pi_previous(zero, _default_prec);
-        caches<>::pi_cached.set_prec(_default_prec);
-        caches<>::pi_cached = zero;
-
-        bool converged = false;
-        int iteration = 0;
-
-        mpf_class epsilon = one;
-        epsilon.div_2exp(_default_prec);
-
-        while (!converged) {
-            iteration++;
-            a_next = (a + b) / two;
-            b_next = sqrt(a * b);
-            t_next = t - p * (a - a_next) * (a - a_next);
-            p = two * p;
-
-            // Update values for the next iteration
-            a = a_next;
-            b = b_next;
-            t = t_next;
-
-            // Calculate pi
-            pi_previous = tmp_pi;
-            tmp_pi = (a + b) * (a + b) / (four * t);
-            // Check for convergence
-            if (abs(tmp_pi - pi_previous) < epsilon) {
-                converged = true;
+// mpf_fixed<Bits>: a float of fixed precision whose limbs are stored inline.
+// The layout matches an mpf_t initialized by mpf_init2(Bits), so every mpf_* function that does
+// not reallocate (i.e. all but mpf_set_prec, mpf_swap and mpf_clear) can be applied to
+// get_mpf_t(). Arrays of mpf_fixed are contiguous and need no per-element allocation; the
+// price is that the precision is a compile-time constant and moves copy the limbs.
+template <mp_bitcnt_t Bits> class mpf_fixed {
+  public:
+    static constexpr int prec_limbs = static_cast<int>((Bits + 2 * GMP_NUMB_BITS - 1) / GMP_NUMB_BITS); // __GMPF_BITS_TO_PREC
+    static constexpr mp_bitcnt_t prec = Bits;
+
+    mpf_fixed() noexcept { init(); }
+    mpf_fixed(const mpf_fixed &op) noexcept {
+        init();
+        mpf_set(value, op.value);
+    }
+    mpf_fixed &operator=(const mpf_fixed &op) noexcept {
+        if (this != &op)
+            mpf_set(value, op.value);
+        return *this;
+    }
+    // the limbs live inside the object, so there is nothing cheaper than a copy
+    mpf_fixed(mpf_fixed &&op) noexcept : mpf_fixed(static_cast<const mpf_fixed &>(op)) {}
+    mpf_fixed &operator=(mpf_fixed &&op) noexcept { return *this = static_cast<const mpf_fixed &>(op); }
+    ~mpf_fixed() = default;
+
+    explicit mpf_fixed(mpf_srcptr op) noexcept {
+        init();
+        mpf_set(value, op);
+    }
+    mpf_fixed(const mpf_class &op) noexcept : mpf_fixed(op.get_mpf_t()) {}
+    mpf_fixed(const unsigned long int op) noexcept {
+        init();
+        mpf_set_ui(value, op);
+    }
+    mpf_fixed(const unsigned int op) noexcept : mpf_fixed(static_cast<unsigned long int>(op)) {}
+    mpf_fixed(const signed long int op) noexcept {
+        init();
+        mpf_set_si(value, op);
+    }
+    mpf_fixed(const signed int op) noexcept : mpf_fixed(static_cast<signed long int>(op)) {}
+    mpf_fixed(const double op) noexcept {
+        init();
+        mpf_set_d(value, op);
+    }
+    explicit mpf_fixed(const char *str) {
+        init();
+        if (mpf_set_str(value, str, gmpxx_defaults::base) != 0)
+            throw std::invalid_argument("");
+    }
+    operator mpf_class() const { return mpf_class(value, Bits); }
+
+    mpf_fixed &operator+=(const mpf_fixed &op) noexcept {
+        mpf_add(value, value, op.value);
+        return *this;
+    }
+    mpf_fixed &operator-=(const mpf_fixed &op) noexcept {
+        mpf_sub(value, value, op.value);
+        return *this;
+    }
+    mpf_fixed &operator*=(const mpf_fixed &op) noexcept {
+        mpf_mul(value, value, op.value);
+        return *this;
+    }
+    mpf_fixed &operator/=(const mpf_fixed &op) noexcept {
+        mpf_div(value, value, op.value);
+        return *this;
+    }
+    friend mpf_fixed operator+(const mpf_fixed &op1, const mpf_fixed &op2) noexcept {
+        mpf_fixed result;
+        mpf_add(result.value, op1.value, op2.value);
+        return result;
+    }
+    friend mpf_fixed operator-(const mpf_fixed &op1, const mpf_fixed &op2) noexcept {
+        mpf_fixed result;
+        mpf_sub(result.value, op1.value, op2.value);
+        return result;
+    }
+    friend mpf_fixed operator*(const mpf_fixed &op1, const mpf_fixed &op2) noexcept {
+        mpf_fixed result;
+        mpf_mul(result.value, op1.value, op2.value);
+        return result;
+    }
+    friend mpf_fixed operator/(const mpf_fixed &op1, const mpf_fixed &op2) noexcept {
+        mpf_fixed result;
+        mpf_div(result.value, op1.value, op2.value);
+        return result;
+    }
+    friend mpf_fixed operator-(const mpf_fixed &op) noexcept {
+        mpf_fixed result;
+        mpf_neg(result.value, op.value);
+        return result;
+    }
+    friend mpf_fixed abs(const mpf_fixed &op) noexcept {
+        mpf_fixed result;
+        mpf_abs(result.value, op.value);
+        return result;
+    }
+    friend mpf_fixed sqrt(const mpf_fixed &op) noexcept {
+        mpf_fixed result;
+        mpf_sqrt(result.value, op.value);
+        return result;
+    }
+    friend int cmp(const mpf_fixed &op1, const mpf_fixed &op2) noexcept { return mpf_cmp(op1.value, op2.value); }
+    friend bool operator==(const mpf_fixed &op1, const mpf_fixed &op2) noexcept { return mpf_cmp(op1.value, op2.value) == 0; }
+    friend bool operator!=(const mpf_fixed &op1, const mpf_fixed &op2) noexcept { return mpf_cmp(op1.value, op2.value) != 0; }
+    friend bool operator<(const mpf_fixed &op1, const mpf_fixed &op2) noexcept { return mpf_cmp(op1.value, op2.value) < 0; }
+    friend bool operator>(const mpf_fixed &op1, const mpf_fixed &op2) noexcept { return mpf_cmp(op1.value, op2.value) > 0; }
+    friend bool operator<=(const mpf_fixed &op1, const mpf_fixed &op2) noexcept { return mpf_cmp(op1.value, op2.value) <= 0; }
+    friend bool operator>=(const mpf_fixed &op1, const mpf_fixed &op2) noexcept { return mpf_cmp(op1.value, op2.value) >= 0; }
+    friend std::ostream &operator<<(std::ostream &os, const mpf_fixed &op) {
+        print_mpf(os, op.value);
+        return os;
+    }
+
+    double get_d() const noexcept { return mpf_get_d(value); }
+    mp_bitcnt_t get_prec() const noexcept { return mpf_get_prec(value); }
+    mpf_srcptr get_mpf_t() const noexcept { return value; }
+    mpf_ptr get_mpf_t() noexcept { return value; }
+
+  private:
+    void init() noexcept {
+        value->_mp_prec = prec_limbs;
+        value->_mp_size = 0;
+        value->_mp_exp = 0;
+        value->_mp_d = limbs;
+    }
+    mpf_t value;
+    mp_limb_t limbs[prec_limbs + 1];
+};
+// mpf_vector and mpf_matrix: floats of a common precision whose headers and limbs share one
+// 64-byte aligned slab, so construction and destruction are one allocation each however many
+// elements there are. Elements are accessed through mpf_ref / mpf_const_ref, views holding an
+// mpf_ptr: assigning to a view writes the value at the container's precision, reading converts
+// to mpf_class, and arithmetic and comparison between views and mpf_class go straight to the
+// mpf_* functions. The mpf_t of an element must not be passed to mpf_set_prec, mpf_swap or
+// mpf_clear.
+class mpf_const_ref {
+  public:
+    explicit mpf_const_ref(mpf_srcptr op) noexcept : ptr(const_cast<mpf_ptr>(op)) {}
+    operator mpf_class() const { return mpf_class(ptr); }
+    double get_d() const noexcept { return mpf_get_d(ptr); }
+    mp_bitcnt_t get_prec() const noexcept { return mpf_get_prec(ptr); }
+    mpf_srcptr get_mpf_t() const noexcept { return ptr; }
+
+  protected:
+    mpf_ptr ptr;
+};
+template <typename T> struct is_mpf_view : std::is_base_of<mpf_const_ref, T> {};
+template <typename T> struct is_mpf_value : std::integral_constant<bool, std::is_same<T, mpf_class>::value || is_mpf_view<T>::value> {};
+inline mpf_srcptr mpf_operand(const mpf_class &op) noexcept { return op.get_mpf_t(); }
+inline mpf_srcptr mpf_operand(const mpf_const_ref &op) noexcept { return op.get_mpf_t(); }
+
+class mpf_ref : public mpf_const_ref {
+  public:
+    explicit mpf_ref(mpf_ptr op) noexcept : mpf_const_ref(op) {}
+    mpf_ref(const mpf_ref &op) noexcept = default;
+    // assignment writes through the view, it never rebinds it
+    mpf_ref &operator=(const mpf_ref &op) noexcept {
+        mpf_set(ptr, op.ptr);
+        return *this;
+    }
+    template <typename T> typename std::enable_if<is_mpf_value<T>::value, mpf_ref &>::type operator=(const T &op) noexcept {
+        mpf_set(ptr, mpf_operand(op));
+        return *this;
+    }
+    template <typename T> UNSIGNED_INT_COND(T, mpf_ref &) operator=(const T op) noexcept {
+        mpf_set_ui(ptr, static_cast<unsigned long int>(op));
+        return *this;
+    }
+    template <typename T> SIGNED_INT_COND(T, mpf_ref &) operator=(const T op) noexcept {
+        mpf_set_si(ptr, static_cast<signed long int>(op));
+        return *this;
+    }
+    mpf_ref &operator=(const double op) noexcept {
+        mpf_set_d(ptr, op);
+        return *this;
+    }
+    template <typename T> typename std::enable_if<!is_mpf_value<T>::value && !std::is_arithmetic<T>::value, mpf_ref &>::type operator=(const T &op) {
+        mpf_class tmp(0.0, get_prec());
+        tmp = op;
+        mpf_set(ptr, tmp.get_mpf_t());
+        return *this;
+    }
+    template <typename T> typename std::enable_if<is_mpf_value<T>::value, mpf_ref &>::type operator+=(const T &op) noexcept {
+        mpf_add(ptr, ptr, mpf_operand(op));
+        return *this;
+    }
+    template <typename T> typename std::enable_if<is_mpf_value<T>::value, mpf_ref &>::type operator-=(const T &op) noexcept {
+        mpf_sub(ptr, ptr, mpf_operand(op));
+        return *this;
+    }
+    template <typename T> typename std::enable_if<is_mpf_value<T>::value, mpf_ref &>::type operator*=(const T &op) noexcept {
+        mpf_mul(ptr, ptr, mpf_operand(op));
+        return *this;
+    }
+    template <typename T> typename std::enable_if<is_mpf_value<T>::value, mpf_ref &>::type operator/=(const T &op) noexcept {
+        mpf_div(ptr, ptr, mpf_operand(op));
+        return *this;
+    }
+    // any other operand goes through the mpf_class operators
+    template <typename T> typename std::enable_if<!is_mpf_value<T>::value, mpf_ref &>::type operator+=(const T &op) { return *this = mpf_class(ptr) + op; }
+    template <typename T> typename std::enable_if<!is_mpf_value<T>::value, mpf_ref &>::type operator-=(const T &op) { return *this = mpf_class(ptr) - op; }
+    template <typename T> typename std::enable_if<!is_mpf_value<T>::value, mpf_ref &>::type operator*=(const T &op) { return *this = mpf_class(ptr) * op; }
+    template <typename T> typename std::enable_if<!is_mpf_value<T>::value, mpf_ref &>::type operator/=(const T &op) { return *this = mpf_class(ptr) / op; }
+    mpf_ptr get_mpf_t() const noexcept { return ptr; }
+};
+// the headers stay in place and the values are exchanged, so every element keeps pointing into its
+// own slab, also when a and b belong to different containers
+inline void swap(mpf_ref a, mpf_ref b) noexcept {
+    mpf_ptr x = a.get_mpf_t(), y = b.get_mpf_t();
+    assert(x->_mp_prec == y->_mp_prec);
+    std::swap(x->_mp_size, y->_mp_size);
+    std::swap(x->_mp_exp, y->_mp_exp);
+    std::swap_ranges(x->_mp_d, x->_mp_d + x->_mp_prec + 1, y->_mp_d);
+}
+// with an mpf_class the values are copied, each rounded to the precision of its new owner
+inline void swap(mpf_ref a, mpf_class &b) {
+    mpf_class tmp(b);
+    mpf_set(b.get_mpf_t(), a.get_mpf_t());
+    mpf_set(a.get_mpf_t(), tmp.get_mpf_t());
+}
+inline void swap(mpf_class &a, mpf_ref b) { swap(b, a); }
+
+#define MPF_VIEW_BINARY_COND(T, U) typename std::enable_if<(is_mpf_view<T>::value || is_mpf_view<U>::value) && is_mpf_value<T>::value && is_mpf_value<U>::value, mpf_class>::type
+#define MPF_VIEW_BINARY_OPERATOR(op, mpf_func)                                                  \
+    template <typename T, typename U> inline MPF_VIEW_BINARY_COND(T, U) op(const T &op1, const U &op2) { \
+        mpf_class result(0.0, mpf_binary_prec(mpf_get_prec(mpf_operand(op1)), mpf_get_prec(mpf_operand(op2)))); \
+        mpf_func(result.get_mpf_t(), mpf_operand(op1), mpf_operand(op2));                   \
+        return result;                                                                       \
+    }
+MPF_VIEW_BINARY_OPERATOR(operator+, mpf_add)
+MPF_VIEW_BINARY_OPERATOR(operator-, mpf_sub)
+MPF_VIEW_BINARY_OPERATOR(operator*, mpf_mul)
+MPF_VIEW_BINARY_OPERATOR(operator/, mpf_div)
+#undef MPF_VIEW_BINARY_OPERATOR
+#undef MPF_VIEW_BINARY_COND
+inline mpf_class operator-(const mpf_const_ref &op) {
+    mpf_class result(0.0, op.get_prec());
+    mpf_neg(result.get_mpf_t(), op.get_mpf_t());
+    return result;
+}
+
+template <typename T> inline typename std::enable_if<is_mpf_value<T>::value, int>::type mpf_view_cmp(mpf_srcptr op1, const T &op2) noexcept { return mpf_cmp(op1, mpf_operand(op2)); }
+template <typename T> inline UNSIGNED_INT_COND(T, int) mpf_view_cmp(mpf_srcptr op1, const T op2) noexcept { return mpf_cmp_ui(op1, static_cast<unsigned long int>(op2)); }
+template <typename T> inline SIGNED_INT_COND(T, int) mpf_view_cmp(mpf_srcptr op1, const T op2) noexcept { return mpf_cmp_si(op1, static_cast<signed long int>(op2)); }
+template <typename T> inline NON_INT_COND(T, int) mpf_view_cmp(mpf_srcptr op1, const T op2) noexcept { return mpf_cmp_d(op1, static_cast<double>(op2)); }
+#define MPF_VIEW_COMPARISON(op, reversed)                                                                                            \
+    template <typename T> inline typename std::enable_if<is_mpf_value<T>::value || std::is_arithmetic<T>::value, bool>::type op(const mpf_const_ref &op1, const T &op2) noexcept { \
+        return mpf_view_cmp(op1.get_mpf_t(), op2) reversed 0;                                                                       \
+    }                                                                                                                               \
+    template <typename T> inline typename std::enable_if<std::is_same<T, mpf_class>::value || std::is_arithmetic<T>::value, bool>::type op(const T &op1, const mpf_const_ref &op2) noexcept { \
+        return 0 reversed mpf_view_cmp(op2.get_mpf_t(), op1);                                                                       \
+    }
+MPF_VIEW_COMPARISON(operator==, ==)
+MPF_VIEW_COMPARISON(operator!=, !=)
+MPF_VIEW_COMPARISON(operator<, <)
+MPF_VIEW_COMPARISON(operator>, >)
+MPF_VIEW_COMPARISON(operator<=, <=)
+MPF_VIEW_COMPARISON(operator>=, >=)
+#undef MPF_VIEW_COMPARISON
+// addmul and submul into a view, or with views as factors
+#define MPF_VIEW_FUSED(name, mpf_func)                                                                                            \
+    template <typename T, typename U> inline typename std::enable_if<is_mpf_value<T>::value && is_mpf_value<U>::value, mpf_ref>::type name(mpf_ref acc, const T &a, const U &b) { \
+        mpf_ptr t = mpf_scratch(mpf_binary_prec(mpf_get_prec(mpf_operand(a)), mpf_get_prec(mpf_operand(b))));                  \
+        mpf_mul(t, mpf_operand(a), mpf_operand(b));                                                                             \
+        mpf_func(acc.get_mpf_t(), acc.get_mpf_t(), t);                                                                          \
+        return acc;                                                                                                            \
+    }                                                                                                                          \
+    template <typename T, typename U> inline typename std::enable_if<(is_mpf_view<T>::value || is_mpf_view<U>::value) && is_mpf_value<T>::value && is_mpf_value<U>::value, mpf_class &>::type name(mpf_class &acc, const T &a, const U &b) { \
+        name(mpf_ref(acc.get_mpf_t()), a, b);                                                                                   \
+        return acc;                                                                                                            \
+    }
+MPF_VIEW_FUSED(addmul, mpf_add)
+MPF_VIEW_FUSED(submul, mpf_sub)
+#undef MPF_VIEW_FUSED
+inline std::ostream &operator<<(std::ostream &os, const mpf_const_ref &op) {
+    print_mpf(os, op.get_mpf_t());
+    return os;
+}
+
+// the storage shared by mpf_vector and mpf_matrix
+class mpf_slab {
+  public:
+    static constexpr size_t alignment = 64;
+
+    mpf_slab() noexcept = default;
+    mpf_slab(size_t n, mp_bitcnt_t prec) { allocate(n, prec); }
+    mpf_slab(const mpf_slab &op) {
+        allocate(op.count, op.prec);
+        for (size_t i = 0; i < count; i++)
+            mpf_set(&headers[i], &op.headers[i]);
+    }
+    mpf_slab &operator=(const mpf_slab &op) {
+        if (this != &op) {
+            mpf_slab tmp(op);
+            swap(tmp);
+        }
+        return *this;
+    }
+    // a moved-from slab is empty
+    mpf_slab(mpf_slab &&op) noexcept { swap(op); }
+    mpf_slab &operator=(mpf_slab &&op) noexcept {
+        mpf_slab tmp(std::move(op));
+        swap(tmp);
+        return *this;
+    }
+    ~mpf_slab() {
+        if (headers != nullptr)
+            ::operator delete(headers, std::align_val_t(alignment));
+    }
+    void swap(mpf_slab &op) noexcept {
+        std::swap(headers, op.headers);
+        std::swap(count, op.count);
+        std::swap(prec, op.prec);
+    }
+    mpf_ptr data() noexcept { return headers; }
+    mpf_srcptr data() const noexcept { return headers; }
+    size_t size() const noexcept { return count; }
+    mp_bitcnt_t get_prec() const noexcept { return prec; }
+
+  private:
+    void allocate(size_t n, mp_bitcnt_t _prec) {
+#if defined ___GMPXX_MKII_NOPRECCHANGE___
+        assert(_prec == mpf_get_default_prec());
+#endif
+        count = n;
+        prec = _prec;
+        if (n == 0)
+            return;
+        int prec_limbs = static_cast<int>((std::max<mp_bitcnt_t>(53, _prec) + 2 * GMP_NUMB_BITS - 1) / GMP_NUMB_BITS); // __GMPF_BITS_TO_PREC
+        size_t stride = static_cast<size_t>(prec_limbs) + 1;
+        size_t header_bytes = (n * sizeof(__mpf_struct) + alignment - 1) / alignment * alignment;
+        void *p = ::operator new(header_bytes + n * stride * sizeof(mp_limb_t), std::align_val_t(alignment));
+        headers = static_cast<__mpf_struct *>(p);
+        mp_limb_t *limbs = reinterpret_cast<mp_limb_t *>(static_cast<char *>(p) + header_bytes);
+        for (size_t i = 0; i < n; i++) {
+            headers[i]._mp_prec = prec_limbs;
+            headers[i]._mp_size = 0;
+            headers[i]._mp_exp = 0;
+            headers[i]._mp_d = limbs + i * stride;
+        }
+    }
+    __mpf_struct *headers = nullptr;
+    size_t count = 0;
+    mp_bitcnt_t prec = 0;
+};
+
+class mpf_vector {
+  public:
+    mpf_vector() noexcept = default;
+    explicit mpf_vector(size_t n, mp_bitcnt_t prec = mpf_get_default_prec()) : slab(n, prec) {}
+
+    mpf_ref operator[](size_t i) noexcept { return mpf_ref(slab.data() + i); }
+    mpf_const_ref operator[](size_t i) const noexcept { return mpf_const_ref(slab.data() + i); }
+    // element i is data() + i
+    mpf_ptr data() noexcept { return slab.data(); }
+    mpf_srcptr data() const noexcept { return slab.data(); }
+    size_t size() const noexcept { return slab.size(); }
+    mp_bitcnt_t get_prec() const noexcept { return slab.get_prec(); }
+
+  private:
+    mpf_slab slab;
+};
+
+// column-major like Rgemv/Rgemm: element (i, j) is data()[i + j * ld()] with ld() >= rows()
+class mpf_matrix {
+  public:
+    mpf_matrix() noexcept = default;
+    mpf_matrix(size_t m, size_t n, mp_bitcnt_t prec = mpf_get_default_prec()) : mpf_matrix(m, n, m, prec) {}
+    mpf_matrix(size_t m, size_t n, size_t lda, mp_bitcnt_t prec) : slab((assert(lda >= m), lda * n), prec), m(m), n(n), lda(lda) {}
+    mpf_matrix(const mpf_matrix &op) = default;
+    mpf_matrix &operator=(const mpf_matrix &op) = default;
+    // a moved-from matrix is empty, like its moved-from slab
+    mpf_matrix(mpf_matrix &&op) noexcept : slab(std::move(op.slab)), m(std::exchange(op.m, 0)), n(std::exchange(op.n, 0)), lda(std::exchange(op.lda, 0)) {}
+    mpf_matrix &operator=(mpf_matrix &&op) noexcept {
+        if (this != &op) {
+            slab = std::move(op.slab);
+            m = std::exchange(op.m, 0);
+            n = std::exchange(op.n, 0);
+            lda = std::exchange(op.lda, 0);
+        }
+        return *this;
+    }
+
+    mpf_ref operator()(size_t i, size_t j) noexcept { return mpf_ref(slab.data() + i + j * lda); }
+    mpf_const_ref operator()(size_t i, size_t j) const noexcept { return mpf_const_ref(slab.data() + i + j * lda); }
+    mpf_ptr data() noexcept { return slab.data(); }
+    mpf_srcptr data() const noexcept { return slab.data(); }
+    size_t rows() const noexcept { return m; }
+    size_t cols() const noexcept { return n; }
+    size_t ld() const noexcept { return lda; }
+    mp_bitcnt_t get_prec() const noexcept { return slab.get_prec(); }
+
+  private:
+    mpf_slab slab;
+    size_t m = 0;
+    size_t n = 0;
+    size_t lda = 0;
+};
+// Cache of a mathematical constant (pi, log2, ...). Only the value of the highest precision
+// computed so far is kept, and a request at a lower precision is served by rounding it down.
+// The value is computed outside the lock, so the computation may use other cached constants
+// and open OpenMP parallel regions; if two threads compute it at once, the more precise value
+// is kept. The mutex makes this safe to call from OpenMP parallel regions.
+class mpf_constant_cache {
+  public:
+    template <typename F> mpf_class get(mp_bitcnt_t req_precision, F compute) {
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            if (cached_value && cached_precision >= req_precision) {
+                if (cached_precision == req_precision)
+                    return *cached_value;
+                return mpf_class(*cached_value, req_precision);
             }
         }
-        calculated = true;
-        caches<>::pi_cached = tmp_pi;
-    } else {
-        //      std::cout << "pi cached\n";
+        mpf_class value = compute(req_precision);
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        if (!cached_value || cached_precision < req_precision) {
+            cached_value.emplace(value);
+            cached_precision = req_precision;
+        }
+        return value;
+    }
+    void reset() {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        cached_value.reset();
+        cached_precision = 0;
+    }
+
+  private:
+    std::mutex cache_mutex;
+    std::optional<mpf_class> cached_value;
+    mp_bitcnt_t cached_precision = 0;
+};
+inline mpf_constant_cache pi_cache;
+inline mpf_constant_cache pi_chudnovsky_cache;
+inline mpf_constant_cache e_cache;
+inline mpf_constant_cache log10_cache;
+inline mpf_constant_cache log2_cache;
+
+#if !defined ___GMPXX_MKII_NOPRECCHANGE___
+// Ziv's strategy: evaluate f at the precision of x plus gmpxx_defaults::ziv_guard_bits, assume
+// an error of 2^ziv_error_bits ulps of the working precision, and accept the result when both
+// ends of the error interval round to the same value at the precision of x. Otherwise the
+// guard bits are doubled and f is evaluated again. The result is rounded to nearest.
+// The acceptance test is a heuristic: the error bound is the same assumed constant for every
+// kernel, not a proven bound of f, so a kernel that is less accurate than assumed can still
+// return a result that is not correctly rounded.
+struct ziv_statistics {
+    unsigned long evaluations = 0;
+    unsigned long retries = 0;
+};
+inline thread_local ziv_statistics ziv_stats;
+
+// nearest integer to v 2^shift
+inline void ziv_round_scaled(const mpf_class &v, long shift, mpz_class &rop) {
+    mpf_class t(v, v.get_prec() + 64);
+    if (shift >= 0)
+        mpf_mul_2exp(t.get_mpf_t(), t.get_mpf_t(), shift);
+    else
+        mpf_div_2exp(t.get_mpf_t(), t.get_mpf_t(), -shift);
+    mpf_class half(0.5, 64);
+    mpf_add(t.get_mpf_t(), t.get_mpf_t(), half.get_mpf_t());
+    mpf_floor(t.get_mpf_t(), t.get_mpf_t());
+    mpz_set_f(rop.get_mpz_t(), t.get_mpf_t());
+}
+template <typename F> mpf_class ziv_evaluate(const mpf_class &x, F f, unsigned int *retries = nullptr) {
+    mp_bitcnt_t req_precision = x.get_prec();
+    mp_bitcnt_t guard_bits = std::max<mp_bitcnt_t>(gmpxx_defaults::ziv_guard_bits, 1);
+    mpz_class m_lo, m_hi;
+    mpf_class y;
+    unsigned int retry = 0;
+    ziv_stats.evaluations++;
+    while (true) {
+        mpf_class y_work = f(mpf_class(x, req_precision + guard_bits));
+        y.swap(y_work); // keeps the working precision
+        if (mpf_sgn(y.get_mpf_t()) == 0)
+            break;
+        mp_bitcnt_t work_precision = y.get_prec();
+        // round y 2^(-64 y_limbs), whose exponent is in [-63, 0], so that the exponents below fit in
+        // a long even when y does not (e.g. exp of a huge argument); y_limbs is restored at the end
+        mp_exp_t y_limbs = y.get_mpf_t()->_mp_exp;
+        mpf_class lo(y, work_precision + 64), hi(y, work_precision + 64);
+        lo.get_mpf_t()->_mp_exp = 0;
+        hi.get_mpf_t()->_mp_exp = 0;
+        mp_exp_t e;
+        mpf_get_d_2exp(&e, lo.get_mpf_t());
+        // [y - err, y + err] with err = 2^(e - work_precision + ziv_error_bits)
+        mpf_class err(1.0, 64);
+        long err_exp = static_cast<long>(e) - static_cast<long>(work_precision) + static_cast<long>(gmpxx_defaults::ziv_error_bits);
+        if (err_exp >= 0)
+            mpf_mul_2exp(err.get_mpf_t(), err.get_mpf_t(), err_exp);
+        else
+            mpf_div_2exp(err.get_mpf_t(), err.get_mpf_t(), -err_exp);
+        mpf_sub(lo.get_mpf_t(), lo.get_mpf_t(), err.get_mpf_t());
+        mpf_add(hi.get_mpf_t(), hi.get_mpf_t(), err.get_mpf_t());
+        long shift = static_cast<long>(req_precision) - static_cast<long>(e);
+        ziv_round_scaled(lo, shift, m_lo);
+        ziv_round_scaled(hi, shift, m_hi);
+        if (m_lo == m_hi) {
+            mpf_class result(0.0, req_precision);
+            mpf_set_z(result.get_mpf_t(), m_lo.get_mpz_t());
+            if (shift >= 0)
+                mpf_div_2exp(result.get_mpf_t(), result.get_mpf_t(), shift);
+            else
+                mpf_mul_2exp(result.get_mpf_t(), result.get_mpf_t(), -shift);
+            if (mpf_sgn(result.get_mpf_t()) != 0)
+                result.get_mpf_t()->_mp_exp += y_limbs;
+            y.swap(result);
+            break;
+        }
+        if (retry == gmpxx_defaults::ziv_max_retries)
+            break;
+        retry++;
+        ziv_stats.retries++;
+        guard_bits *= 2;
     }
-    return caches<>::pi_cached;
+    if (retries)
+        *retries = retry;
+    mpf_class result(y, req_precision);
+    return result;
 }
-inline mpf_class const_pi(mp_bitcnt_t req_precision) {
+#endif
+
+inline mpf_class const_pi_AGM(mp_bitcnt_t req_precision) {
 #if defined ___GMPXX_MKII_NOPRECCHANGE___
     assert(req_precision == mpf_get_default_prec());
 #endif
     // calculating approximate pi using arithmetic-geometric mean
-    mpf_class zero(0.0, req_precision);
-    mpf_class quarter(0.25, req_precision);
-    mpf_class one(1.0, req_precision);
-    mpf_class two(2.0, req_precision);
-    mpf_class four(4.0, req_precision);
-
-    mpf_class calculated_pi(zero, req_precision);
-    mpf_class a(one, req_precision), b(one / sqrt(two), req_precision), t(quarter, req_precision), p(one, req_precision);
-    mpf_class a_next(zero, req_precision), b_next(zero, req_precision), t_next(zero, req_precision), tmp_pi(zero, req_precision), pi_previous(zero, req_precision);
-    mpf_class epsilon(zero, req_precision), tmp(zero, req_precision);
-
-    assert(calculated_pi.get_prec() == req_precision);
-    assert(a.get_prec() == req_precision);
-    assert(b.get_prec() == req_precision);
-    assert(t.get_prec() == req_precision);
-    assert(p.get_prec() == req_precision);
-    assert(a_next.get_prec() == req_precision);
-    assert(b_next.get_prec() == req_precision);
-    assert(t_next.get_prec() == req_precision);
-    assert(tmp_pi.get_prec() == req_precision);
-    assert(pi_previous.get_prec() == req_precision);
-    assert(epsilon.get_prec() == req_precision);
-    assert(tmp.get_prec() == req_precision);
-
+    mpf_class calculated_pi(0.0, req_precision);
+    scratch_scope scope;
+    mpf_ptr a = scope.get(req_precision, 1UL);
+    mpf_ptr b = scope.get(req_precision, 2UL);
+    mpf_ptr t = scope.get(req_precision, 1UL);
+    mpf_ptr p = scope.get(req_precision, 1UL);
+    mpf_ptr a_next = scope.get(req_precision);
+    mpf_ptr b_next = scope.get(req_precision);
+    mpf_ptr tmp_pi = scope.get(req_precision);
+    mpf_ptr pi_previous = scope.get(req_precision);
+    mpf_ptr epsilon = scope.get(req_precision, 1UL);
+    mpf_ptr tmp = scope.get(req_precision);
+    mpf_ptr u = scope.get(req_precision);
+    mpf_ptr two = scope.get(req_precision, 2UL);
+    mpf_ptr four = scope.get(req_precision, 4UL);
+
+    mpf_sqrt(b, b);
+    mpf_ui_div(b, 1, b);
+    mpf_div_2exp(t, t, 2);
+    mpf_div_2exp(epsilon, epsilon, req_precision);
     bool converged = false;
-    int iteration = 0;
-
-    epsilon = one;
-    epsilon.div_2exp(req_precision);
     while (!converged) {
-        iteration++;
-        a_next = (a + b) / two;
-        b_next = sqrt(a * b);
-        t_next = t - p * (a - a_next) * (a - a_next);
-        p = two * p;
+        mpf_add(a_next, a, b);
+        mpf_div(a_next, a_next, two);
+        mpf_mul(tmp, a, b);
+        mpf_sqrt(b_next, tmp);
+        mpf_sub(tmp, a, a_next);
+        mpf_mul(u, p, tmp);
+        mpf_mul(u, u, tmp);
+        mpf_sub(t, t, u);
+        mpf_mul(p, two, p);
 
         // Update values for the next iteration
-        a = a_next;
-        b = b_next;
-        t = t_next;
+        std::swap(a, a_next);
+        std::swap(b, b_next);
 
         // Calculate pi
-        pi_previous = tmp_pi;
-        tmp_pi = (a + b) * (a + b) / (four * t);
+        std::swap(pi_previous, tmp_pi);
+        mpf_add(tmp, a, b);
+        mpf_mul(tmp, tmp, tmp);
+        mpf_mul(u, four, t);
+        mpf_div(tmp_pi, tmp, u);
 
         // Check for convergence
-        tmp = abs(tmp_pi - pi_previous);
-        if (tmp < epsilon) {
+        mpf_sub(tmp, tmp_pi, pi_previous);
+        mpf_abs(tmp, tmp);
+        if (mpf_cmp(tmp, epsilon) < 0) {
             converged = true;
         }
     }
-    calculated_pi = tmp_pi;
+    mpf_set(calculated_pi.get_mpf_t(), tmp_pi);
     assert(calculated_pi.get_prec() == req_precision);
-    assert(a.get_prec() == req_precision);
-    assert(b.get_prec() == req_precision);
-    assert(t.get_prec() == req_precision);
-    assert(p.get_prec() == req_precision);
-    assert(a_next.get_prec() == req_precision);
-    assert(b_next.get_prec() == req_precision);
-    assert(t_next.get_prec() == req_precision);
-    assert(tmp_pi.get_prec() == req_precision);
-    assert(pi_previous.get_prec() == req_precision);
-    assert(epsilon.get_prec() == req_precision);
-    assert(tmp.get_prec() == req_precision);
-
     return calculated_pi;
 }
 
-inline mpf_class const_log2() {
-    static mpf_class log2_cached;
-    static bool calculated = false;
-    static mp_bitcnt_t calculated_log2_precision = 0;
-    mp_bitcnt_t _default_prec = mpf_get_default_prec();
-
-    if (!calculated || (calculated && calculated_log2_precision != _default_prec)) {
-        log2_cached = mpf_class();
-        calculated_log2_precision = mpf_get_default_prec();
-        // calculating approximate log2 using arithmetic-geometric mean
-        mpf_class zero(0.0);
-        mpf_class one(1.0);
-        mpf_class two(2.0);
-        mpf_class a(one);
-        mpf_class epsilon = one;
-        epsilon.div_2exp((_default_prec / 2) - 2);
-
-        log2_cached.set_prec(_default_prec);
-        log2_cached = zero;
-
-        mpf_class b = epsilon;
-        mpf_class sum = one;
-        mpf_class a_next, b_next;
-        mpf_class tmp;
-
-        bool converged = false;
-
-        while (!converged) {
-            a_next = (a + b) / two;
-            b_next = sqrt(a * b);
-
-            // Check for convergence
-            if (abs(a - b) < epsilon) {
-                converged = true;
-            }
-            a = a_next;
-            b = b_next;
+// Binary splitting of hypergeometric-type series
+//   S(a,b) = \sum_{n=a}^{b-1} c(n) p(a) p(a+1) ... p(n) / (q(a) q(a+1) ... q(n))
+// with integer c(n), p(n) and q(n). The functors are called as f(n, result) and store their
+// value into the mpz_class result; they must be safe to call concurrently. On return
+// P = p(a) ... p(b-1), Q = q(a) ... q(b-1) and T = S(a,b) Q. When compiled with OpenMP,
+// the two halves of the product tree are evaluated as tasks near the root.
+template <typename Coefficient, typename Numerator, typename Denominator>
+void hypergeometric_binary_splitting(unsigned long a, unsigned long b, const Coefficient &c, const Numerator &p, const Denominator &q, mpz_class &P, mpz_class &Q, mpz_class &T, int depth = 0) {
+    if (b - a == 1) {
+        p(a, P);
+        q(a, Q);
+        c(a, T);
+        mpz_mul(T.get_mpz_t(), T.get_mpz_t(), P.get_mpz_t());
+        return;
+    }
+    unsigned long m = a + (b - a) / 2;
+    mpz_class P1, Q1, T1, P2, Q2, T2;
+#if defined _OPENMP
+#pragma omp task shared(c, p, q, P1, Q1, T1) if (depth < 8 && b - a > 1024)
+#endif
+    hypergeometric_binary_splitting(a, m, c, p, q, P1, Q1, T1, depth + 1);
+    hypergeometric_binary_splitting(m, b, c, p, q, P2, Q2, T2, depth + 1);
+#if defined _OPENMP
+#pragma omp taskwait
+#endif
+    mpz_mul(P.get_mpz_t(), P1.get_mpz_t(), P2.get_mpz_t());
+    mpz_mul(Q.get_mpz_t(), Q1.get_mpz_t(), Q2.get_mpz_t());
+    mpz_mul(T.get_mpz_t(), T1.get_mpz_t(), Q2.get_mpz_t());
+    mpz_addmul(T.get_mpz_t(), P1.get_mpz_t(), T2.get_mpz_t());
+}
+// S(0, terms) = T / Q rounded to req_precision
+template <typename Coefficient, typename Numerator, typename Denominator>
+mpf_class hypergeometric_sum(unsigned long terms, const Coefficient &c, const Numerator &p, const Denominator &q, mp_bitcnt_t req_precision) {
+    mpz_class P, Q, T;
+#if defined _OPENMP
+#pragma omp parallel if (terms > 1024)
+#pragma omp single
+#endif
+    hypergeometric_binary_splitting(0, terms, c, p, q, P, Q, T);
+    mpf_class sum(T.get_mpz_t(), req_precision);
+    mpf_class _q(Q.get_mpz_t(), req_precision);
+    mpf_div(sum.get_mpf_t(), sum.get_mpf_t(), _q.get_mpf_t());
+    return sum;
+}
+// Chudnovsky series
+//   1/pi = 12 \sum_n (-1)^n (6n)! (13591409 + 545140134 n) / ((3n)! (n!)^3 640320^(3n+3/2)),
+// the ratio of consecutive terms is -(6n-5)(2n-1)(6n-1) / (n^3 640320^3 / 24).
+inline mpf_class const_pi_chudnovsky(mp_bitcnt_t req_precision) {
+    // each term adds log2(640320^3 / 1728) ~ 47.11 bits
+    unsigned long terms = req_precision / 47 + 2;
+    mp_bitcnt_t work_precision = req_precision + 64;
+    auto c = [](unsigned long n, mpz_class &r) {
+        r = 545140134UL;
+        r *= n;
+        r += 13591409UL;
+    };
+    auto p = [](unsigned long n, mpz_class &r) {
+        if (n == 0) {
+            r = 1;
+            return;
         }
-        log2_cached = const_pi() / (mpf_class(_default_prec) * a);
-        calculated = true;
-    }
-    return log2_cached;
+        r = 6 * n - 5;
+        r *= 2 * n - 1;
+        r *= 6 * n - 1;
+        mpz_neg(r.get_mpz_t(), r.get_mpz_t());
+    };
+    auto q = [](unsigned long n, mpz_class &r) {
+        if (n == 0) {
+            r = 1;
+            return;
+        }
+        r = n;
+        r *= n;
+        r *= n;
+        r *= 10939058860032000UL; // 640320^3 / 24
+    };
+    // pi = 426880 sqrt(10005) / S
+    mpf_class pi(10005, work_precision);
+    mpf_class sum = hypergeometric_sum(terms, c, p, q, work_precision);
+    mpf_sqrt(pi.get_mpf_t(), pi.get_mpf_t());
+    mpf_mul_ui(pi.get_mpf_t(), pi.get_mpf_t(), 426880);
+    mpf_div(pi.get_mpf_t(), pi.get_mpf_t(), sum.get_mpf_t());
+    mpf_class calculated_pi(pi, req_precision);
+    return calculated_pi;
 }
-inline mpf_class const_log2(mp_bitcnt_t req_precision) {
+// pi by the backend selected by gmpxx_defaults::pi_algorithm; each backend has its own cache, so
+// a value computed by one backend is never returned after switching to the other
+inline mpf_class const_pi_cached(mp_bitcnt_t req_precision) {
+    if (gmpxx_defaults::pi_algorithm == const_pi_algorithm::chudnovsky)
+        return pi_chudnovsky_cache.get(req_precision, const_pi_chudnovsky);
+    return pi_cache.get(req_precision, const_pi_AGM);
+}
+inline mpf_class const_pi(mp_bitcnt_t req_precision) {
+#if defined ___GMPXX_MKII_NOPRECCHANGE___
+    assert(req_precision == mpf_get_default_prec());
+#endif
+    return const_pi_cached(req_precision);
+}
+inline mpf_class const_pi() { return const_pi(mpf_get_default_prec()); }
+inline mpf_class mpf_class::const_pi() { return const_pi_cached(mpf_get_default_prec()); }
+inline void mpf_class::reset_pi_cache() {
+    pi_cache.reset();
+    pi_chudnovsky_cache.reset();
+}
+inline mpf_class const_log2_AGM(mp_bitcnt_t req_precision) {
 #if defined ___GMPXX_MKII_NOPRECCHANGE___
     assert(req_precision == mpf_get_default_prec());
 #endif
@@ -3685,78 +5341,213 @@ inline mpf_class const_log2(mp_bitcnt_t req_precision) {
 
     return log2;
 }
-inline mpf_class log(const mpf_class &x) {
+inline mpf_class const_log2(mp_bitcnt_t req_precision) {
+#if defined ___GMPXX_MKII_NOPRECCHANGE___
+    assert(req_precision == mpf_get_default_prec());
+#endif
+    return log2_cache.get(req_precision, const_log2_AGM);
+}
+inline mpf_class const_log2() { return const_log2(mpf_get_default_prec()); }
+inline mpf_class mpf_class::const_log2() { return log2_cache.get(mpf_get_default_prec(), const_log2_AGM); }
+inline void mpf_class::reset_log2_cache() { log2_cache.reset(); }
+inline mpf_class log_AGM(const mpf_class &x) {
     mp_bitcnt_t req_precision = x.get_prec();
 #if defined ___GMPXX_MKII_NOPRECCHANGE___
     assert(req_precision == mpf_get_default_prec());
 #endif
-    mpf_class zero(0.0, req_precision);
-    mpf_class one(1.0, req_precision);
-    mpf_class two(2.0, req_precision);
-    mpf_class four(4.0, req_precision);
-
-    mpf_class _log(zero);
-    mpf_class epsilon(one), tmp(zero);
-    mpf_class a(one), b(one);
-    mpf_class a_next(zero), b_next(zero);
-    mpf_class s(one);
-    mpf_class _pi(const_pi(req_precision));
-    mpf_class _log2(const_log2(req_precision));
+    const mpf_class _pi(const_pi(req_precision));
+    const mpf_class _log2(const_log2(req_precision));
+    mpf_class _log(0.0, req_precision);
     mp_exp_t m;
-    bool converged = false;
-
-    assert(_log.get_prec() == req_precision);
-    assert(epsilon.get_prec() == req_precision);
-    assert(tmp.get_prec() == req_precision);
-    assert(a.get_prec() == req_precision);
-    assert(b.get_prec() == req_precision);
-    assert(a_next.get_prec() == req_precision);
-    assert(b_next.get_prec() == req_precision);
-    assert(s.get_prec() == req_precision);
-    assert(_pi.get_prec() == req_precision);
-    assert(_log2.get_prec() == req_precision);
+    scratch_scope scope;
+    mpf_ptr a = scope.get(req_precision, 1UL);
+    mpf_ptr b = scope.get(req_precision, 1UL);
+    mpf_ptr a_next = scope.get(req_precision);
+    mpf_ptr b_next = scope.get(req_precision);
+    mpf_ptr s = scope.get(req_precision);
+    mpf_ptr epsilon = scope.get(req_precision, 1UL);
+    mpf_ptr tmp = scope.get(req_precision);
 
     // calculating approximate log2 using arithmetic-geometric mean
-    b = one;
-    b.mul_2exp(req_precision / 2);
-    s = b / x;
-    mpf_get_d_2exp(&m, s.get_mpf_t());
+    mpf_mul_2exp(b, b, req_precision / 2);
+    mpf_div(s, b, x.get_mpf_t());
+    mpf_get_d_2exp(&m, s);
 
-    b = one;
-    b.mul_2exp(m);
-    s = x * b;
+    mpf_set_ui(b, 1);
+    mpf_mul_2exp(b, b, m);
+    mpf_mul(s, x.get_mpf_t(), b);
 
-    b = four / s;
-    epsilon.div_2exp(req_precision);
-    int counter = 0;
+    mpf_ui_div(b, 4, s);
+    mpf_div_2exp(epsilon, epsilon, req_precision);
+    bool converged = false;
     while (!converged) {
-        counter++;
-        a_next = (a + b) / two;
-        b_next = sqrt(a * b);
+        mpf_add(a_next, a, b);
+        mpf_div_2exp(a_next, a_next, 1);
+        mpf_mul(tmp, a, b);
+        mpf_sqrt(b_next, tmp);
 
         // Check for convergence
-        if (abs(a - b) < epsilon) {
+        mpf_sub(tmp, a, b);
+        mpf_abs(tmp, tmp);
+        if (mpf_cmp(tmp, epsilon) < 0) {
             converged = true;
         }
-        a = a_next;
-        b = b_next;
+        std::swap(a, a_next);
+        std::swap(b, b_next);
     }
-    _log = _pi / (two * b) - m * _log2;
-
+    mpf_mul_2exp(tmp, b, 1);
+    mpf_div(_log.get_mpf_t(), _pi.get_mpf_t(), tmp);
+    if (m >= 0) {
+        mpf_mul_ui(tmp, _log2.get_mpf_t(), static_cast<unsigned long int>(m));
+    } else {
+        mpf_mul_ui(tmp, _log2.get_mpf_t(), static_cast<unsigned long int>(-m));
+        mpf_neg(tmp, tmp);
+    }
+    mpf_sub(_log.get_mpf_t(), _log.get_mpf_t(), tmp);
     assert(_log.get_prec() == req_precision);
-    assert(epsilon.get_prec() == req_precision);
-    assert(tmp.get_prec() == req_precision);
-    assert(a.get_prec() == req_precision);
-    assert(b.get_prec() == req_precision);
-    assert(a_next.get_prec() == req_precision);
-    assert(b_next.get_prec() == req_precision);
-    assert(s.get_prec() == req_precision);
-    assert(_pi.get_prec() == req_precision);
-    assert(_log2.get_prec() == req_precision);
-
     return _log;
 }
-inline mpf_class exp(const mpf_class &x) {
+inline mpf_class log(const mpf_class &x) {
+#if defined ___GMPXX_MKII_ZIV___
+    return ziv_evaluate(x, log_AGM);
+#else
+    return log_AGM(x);
+#endif
+}
+// e = \sum_{n>=0} 1/n! by binary splitting
+inline mpf_class const_e_binary_splitting(mp_bitcnt_t req_precision) {
+    mp_bitcnt_t work_precision = req_precision + 64;
+    // smallest number of terms with log2(terms!) > work_precision
+    unsigned long terms = 1;
+    double log2_factorial = 0.0;
+    while (log2_factorial <= static_cast<double>(work_precision)) {
+        terms++;
+        log2_factorial += std::log2(static_cast<double>(terms));
+    }
+    auto one = [](unsigned long, mpz_class &r) { r = 1; };
+    auto q = [](unsigned long n, mpz_class &r) { r = (n == 0 ? 1UL : n); };
+    mpf_class e = hypergeometric_sum(terms + 1, one, one, q, work_precision);
+    mpf_class calculated_e(e, req_precision);
+    return calculated_e;
+}
+inline mpf_class const_e(mp_bitcnt_t req_precision) {
+#if defined ___GMPXX_MKII_NOPRECCHANGE___
+    assert(req_precision == mpf_get_default_prec());
+#endif
+    return e_cache.get(req_precision, const_e_binary_splitting);
+}
+inline mpf_class const_e() { return const_e(mpf_get_default_prec()); }
+inline mpf_class mpf_class::const_e() { return e_cache.get(mpf_get_default_prec(), const_e_binary_splitting); }
+inline void mpf_class::reset_e_cache() { e_cache.reset(); }
+// atanh(1/q) = sum_k 1 / ((2k+1) q^(2k+1)) on raw mpf_t, for constants needed with guard bits
+// where the NOPRECCHANGE mode cannot evaluate them through mpf_class
+inline void atanh_inv_ui(mpf_t result, unsigned long q, mp_bitcnt_t prec) {
+    mpf_t power, term;
+    mpf_init2(power, prec);
+    mpf_init2(term, prec);
+    mpf_set_ui(power, 1);
+    mpf_div_ui(power, power, q);
+    mpf_set(result, power);
+    unsigned long terms = (unsigned long)(prec / (2 * std::log2((double)q))) + 2;
+    for (unsigned long k = 1; k <= terms; k++) {
+        mpf_div_ui(power, power, q);
+        mpf_div_ui(power, power, q);
+        mpf_div_ui(term, power, 2 * k + 1);
+        mpf_add(result, result, term);
+    }
+    mpf_clear(term);
+    mpf_clear(power);
+}
+inline mpf_class const_log10_from_log(mp_bitcnt_t req_precision) {
+#if defined ___GMPXX_MKII_NOPRECCHANGE___
+    // log() has no guard bits in this mode; log(10) = 3 log(2) + log(5/4) = 6 atanh(1/3) + 2 atanh(1/9)
+    mpf_t a, b;
+    mpf_init2(a, req_precision + 64);
+    mpf_init2(b, req_precision + 64);
+    atanh_inv_ui(a, 3, req_precision + 64);
+    atanh_inv_ui(b, 9, req_precision + 64);
+    mpf_mul_ui(a, a, 3);
+    mpf_add(a, a, b);
+    mpf_mul_2exp(a, a, 1);
+    mpf_class calculated_log10(0, req_precision);
+    mpf_set(calculated_log10.get_mpf_t(), a);
+    mpf_clear(b);
+    mpf_clear(a);
+    return calculated_log10;
+#else
+    // log() loses a few bits through pi / (2 AGM) - m log2; evaluate with guard bits
+    mpf_class calculated_log10(log(mpf_class(10, req_precision + 64)), req_precision);
+    return calculated_log10;
+#endif
+}
+inline mpf_class const_log10(mp_bitcnt_t req_precision) {
+#if defined ___GMPXX_MKII_NOPRECCHANGE___
+    assert(req_precision == mpf_get_default_prec());
+#endif
+    return log10_cache.get(req_precision, const_log10_from_log);
+}
+inline mpf_class const_log10() { return const_log10(mpf_get_default_prec()); }
+inline mpf_class mpf_class::const_log10() { return log10_cache.get(mpf_get_default_prec(), const_log10_from_log); }
+inline void mpf_class::reset_log10_cache() { log10_cache.reset(); }
+// Paterson-Stockmeyer (rectangular splitting) evaluation of
+//   \sum_{j=0}^{n} y^j / (d(1) d(2) ... d(j)),
+// where d(j) is an unsigned long and n is chosen so that the truncation error is below
+// 2^-prec relative to the largest term. With m ~ sqrt(n), y^2 ... y^m and one multiplication
+// per block of m terms are the only non-scalar multiplications; the coefficients are
+// applied by mpf_div_ui.
+template <typename Denominator> void paterson_stockmeyer(mpf_ptr sum, mpf_srcptr y, Denominator d) {
+    mp_bitcnt_t req_precision = mpf_get_prec(sum);
+    mpf_set_ui(sum, 1);
+    if (mpf_sgn(y) == 0)
+        return;
+
+    // number of terms
+    long y_exp;
+    double log2_y = std::log2(std::fabs(mpf_get_d_2exp(&y_exp, y))) + y_exp;
+    double log2_term = 0.0, log2_max_term = 0.0;
+    unsigned long n = 0;
+    while (log2_term > log2_max_term - static_cast<double>(req_precision) || log2_term >= log2_max_term) {
+        n++;
+        log2_term += log2_y - std::log2(static_cast<double>(d(n)));
+        log2_max_term = std::max(log2_max_term, log2_term);
+    }
+    unsigned long m = static_cast<unsigned long>(std::ceil(std::sqrt(static_cast<double>(n))));
+
+    // y^0 ... y^m
+    scratch_scope scope;
+    std::vector<mpf_ptr> powers;
+    powers.reserve(m + 1);
+    powers.push_back(scope.get(req_precision, 1UL));
+    powers.push_back(scope.get(req_precision, y));
+    for (unsigned long i = 2; i <= m; i++) {
+        powers.push_back(scope.get(req_precision));
+        mpf_mul(powers[i], powers[i - 1], y);
+    }
+    // Horner in y^m over the blocks, from the (possibly partial) top block down
+    bool top = true;
+    for (unsigned long b = n / m + 1; b-- > 0;) {
+        unsigned long j0 = b * m;
+        unsigned long i = std::min(m - 1, n - j0);
+        if (top) {
+            mpf_set(sum, powers[i]);
+            top = false;
+        } else {
+            mpf_mul(sum, sum, powers[m]);
+            mpf_div_ui(sum, sum, d(j0 + i + 1));
+            mpf_add(sum, sum, powers[i]);
+        }
+        while (i-- > 0) {
+            mpf_div_ui(sum, sum, d(j0 + i + 1));
+            mpf_add(sum, sum, powers[i]);
+        }
+    }
+}
+template <typename Denominator> mpf_class paterson_stockmeyer(const mpf_class &y, Denominator d) {
+    mpf_class sum(0.0, y.get_prec());
+    paterson_stockmeyer(sum.get_mpf_t(), y.get_mpf_t(), d);
+    return sum;
+}
+inline mpf_class exp_taylor(const mpf_class &x) {
     // https://www.mpfr.org/algorithms.pdf section 4.4
     mp_bitcnt_t req_precision = x.get_prec();
 #if defined ___GMPXX_MKII_NOPRECCHANGE___
@@ -3769,7 +5560,7 @@ inline mpf_class exp(const mpf_class &x) {
     mpf_class r(zero);
     mpf_class _pi(const_pi(req_precision));
     mpf_class _log2(const_log2(req_precision));
-    mp_exp_t k = 0, l = 0, n = 0;
+    mp_exp_t k = 0, n = 0;
 
     if (x < zero)
         _x = -_x; // avoid cancellation of significant digits
@@ -3781,16 +5572,12 @@ inline mpf_class exp(const mpf_class &x) {
         _log2.div_2exp(k); // log2/2 = 0.346574
         n = floor(_x / _log2).get_si();
         r = _x - n * _log2;
-        l = req_precision / k;
     } else {
         k = 0;
-        l = req_precision;
         r = _x;
         n = 0;
     }
-    for (int i = l; i > 0; i--) {
-        _exp = one + ((r * _exp) / mpf_class(i, req_precision));
-    }
+    _exp = paterson_stockmeyer(r, [](unsigned long j) { return j; });
     for (int i = 0; i < k; i++) {
         _exp = _exp * _exp;
     }
@@ -3802,6 +5589,105 @@ inline mpf_class exp(const mpf_class &x) {
         _exp = one / _exp; // avoid cancellation of significant digits
     return _exp;
 }
+// Brent's bit-burst algorithm: x = n log2 + r with 0 <= r < log2, and r is split into
+// chunks r = m_0 / 2^8 + m_1 / 2^16 + m_2 / 2^32 + ..., where m_j has at most as many bits
+// as the previous chunks together. exp(r) is the product of exp(m_j / 2^s_j), and each factor
+// is summed exactly by binary splitting, so the cost is quasi-linear in the precision.
+inline mpf_class exp_bit_burst(const mpf_class &x) {
+    mp_bitcnt_t req_precision = x.get_prec();
+#if defined ___GMPXX_MKII_NOPRECCHANGE___
+    assert(req_precision == mpf_get_default_prec());
+#endif
+    // n log2 cancels the integer part of x / log2; keep its bits as guard bits
+    mp_exp_t x_exp = 0;
+    mpf_get_d_2exp(&x_exp, x.get_mpf_t());
+    mp_bitcnt_t work_precision = req_precision + 64 + (x_exp > 0 ? x_exp : 0);
+    work_precision = (work_precision + mp_bits_per_limb - 1) / mp_bits_per_limb * mp_bits_per_limb;
+#if defined ___GMPXX_MKII_NOPRECCHANGE___
+    // const_log2 only serves the default precision in this mode; log2 = 2 atanh(1/3)
+    mpf_class _log2(0.0, work_precision);
+    atanh_inv_ui(_log2.get_mpf_t(), 3, work_precision);
+    mpf_mul_2exp(_log2.get_mpf_t(), _log2.get_mpf_t(), 1);
+#else
+    mpf_class _log2(const_log2(work_precision));
+#endif
+    mpf_class r(0.0, work_precision), t(0.0, work_precision);
+
+    // x = n log2 + r; n does not need to fit in a long, since the result is scaled by
+    // exponent arithmetic below
+    mpz_class n;
+    mpf_div(t.get_mpf_t(), x.get_mpf_t(), _log2.get_mpf_t());
+    mpf_floor(t.get_mpf_t(), t.get_mpf_t());
+    mpz_set_f(n.get_mpz_t(), t.get_mpf_t());
+    mpf_mul(t.get_mpf_t(), _log2.get_mpf_t(), t.get_mpf_t());
+    mpf_sub(r.get_mpf_t(), x.get_mpf_t(), t.get_mpf_t());
+    if (mpf_sgn(r.get_mpf_t()) < 0) // rounding of x / log2
+        mpf_set_ui(r.get_mpf_t(), 0);
+
+    // R = floor(r 2^work_precision)
+    mpz_class R;
+    mpf_mul_2exp(t.get_mpf_t(), r.get_mpf_t(), work_precision);
+    mpz_set_f(R.get_mpz_t(), t.get_mpf_t());
+
+    mpf_class _exp(1.0, work_precision), factor(0.0, work_precision);
+    mpz_class m;
+    mp_bitcnt_t s_prev = 0;
+    for (mp_bitcnt_t s = 8; s_prev < work_precision; s *= 2) {
+        if (s > work_precision)
+            s = work_precision;
+        // m = bits s_prev+1 ... s of r
+        mpz_fdiv_q_2exp(m.get_mpz_t(), R.get_mpz_t(), work_precision - s);
+        mpz_fdiv_r_2exp(m.get_mpz_t(), m.get_mpz_t(), s - s_prev);
+        s_prev = s;
+        if (mpz_sgn(m.get_mpz_t()) == 0)
+            continue;
+        // smallest number of terms with m^k / (k! 2^(sk)) < 2^-work_precision
+        double bits_per_term = static_cast<double>(s) - static_cast<double>(mpz_sizeinbase(m.get_mpz_t(), 2));
+        double log2_factorial = 0.0;
+        unsigned long terms = 1;
+        while (terms * bits_per_term + log2_factorial <= static_cast<double>(work_precision)) {
+            terms++;
+            log2_factorial += std::log2(static_cast<double>(terms));
+        }
+        // exp(m / 2^s) = \sum_n m^n / (n! 2^(sn))
+        auto one = [](unsigned long, mpz_class &r) { r = 1; };
+        auto p = [&m](unsigned long n, mpz_class &r) {
+            if (n == 0)
+                r = 1;
+            else
+                r = m;
+        };
+        auto q = [s](unsigned long n, mpz_class &r) {
+            if (n == 0)
+                r = 1;
+            else
+                mpz_mul_2exp(r.get_mpz_t(), mpz_class(n).get_mpz_t(), s);
+        };
+        factor = hypergeometric_sum(terms + 1, one, p, q, work_precision);
+        mpf_mul(_exp.get_mpf_t(), _exp.get_mpf_t(), factor.get_mpf_t());
+    }
+    // multiply by 2^n: n = limbs * mp_bits_per_limb + bits with 0 <= bits < mp_bits_per_limb;
+    // the bits are shifted in and the limbs are added to the exponent, which is counted in limbs
+    mpz_class limbs, bits;
+    mpz_fdiv_qr_ui(limbs.get_mpz_t(), bits.get_mpz_t(), n.get_mpz_t(), mp_bits_per_limb);
+    mpf_mul_2exp(_exp.get_mpf_t(), _exp.get_mpf_t(), bits.get_ui());
+    mpz_add_ui(limbs.get_mpz_t(), limbs.get_mpz_t(), static_cast<unsigned long>(_exp.get_mpf_t()->_mp_exp)); // exp(r) >= 1
+    if (!mpz_fits_slong_p(limbs.get_mpz_t())) {
+        if (mpz_sgn(limbs.get_mpz_t()) < 0) // underflow
+            return mpf_class(0.0, req_precision);
+        throw std::overflow_error("exp: result is too large");
+    }
+    _exp.get_mpf_t()->_mp_exp = limbs.get_si();
+    mpf_class result(_exp, req_precision);
+    return result;
+}
+inline mpf_class exp(const mpf_class &x) {
+#if defined ___GMPXX_MKII_ZIV___
+    return ziv_evaluate(x, exp_bit_burst);
+#else
+    return exp_bit_burst(x);
+#endif
+}
 inline mpf_class mpf_remainder(const mpf_class &x, const mpf_class &y, mpz_class *quotient_out = nullptr) {
     mpf_class quotient = x / y;
     mpz_class int_quotient(quotient);
@@ -3817,6 +5703,17 @@ inline mpf_class mpf_remainder(const mpf_class &x, const mpf_class &y, mpz_class
     }
     return remainder;
 }
+// rop = x - n y with the integer n = trunc(x / y), plus y if that is negative
+inline void mpf_remainder(mpf_ptr rop, mpf_srcptr x, mpf_srcptr y) {
+    scratch_scope scope;
+    mpf_ptr q = scope.get(std::max(mpf_get_prec(x), mpf_get_prec(y)));
+    mpf_div(q, x, y);
+    mpf_trunc(q, q);
+    mpf_mul(q, q, y);
+    mpf_sub(rop, x, q);
+    if (mpf_sgn(rop) < 0)
+        mpf_add(rop, rop, y);
+}
 // Naive Taylor expansion version. It generates a very long series.
 inline mpf_class cos_taylor_naive(const mpf_class &x) {
     mp_bitcnt_t req_precision = x.get_prec();
@@ -3893,85 +5790,68 @@ inline mpf_class cos_taylor_reduced(const mpf_class &x, bool addprec = false) {
     }
     mp_bitcnt_t req_precision = _req_precision + additional_precision;
     // Constants and variables
-    mpf_class zero(0.0, req_precision);
-    mpf_class one(1.0, req_precision);
-    mpf_class two(2.0, req_precision);
-    mpf_class r(0.0, req_precision);
-    mpf_class s(0.0, req_precision);
-    mpf_class t(0.0, req_precision);
-    mpf_class l(0.0, req_precision);
-    mpf_class epsilon(1.0, req_precision);
-    mpf_class _s(0.0, _req_precision);
-    r = x;
-    r = r * r;
-    r.div_2exp((k * 2));
-    epsilon.div_2exp(req_precision);
-    s = zero;
-    t = one;
-    l = one;
-    int counter = 0;
-    for (mp_bitcnt_t _l = 1; _l < _req_precision; _l++) {
-        t *= r;
-        t /= ((two * l - one) * (two * l));
-        if (t < epsilon) {
-            break;
-        }
-        if (_l % 2 == 1) {
-            s -= t;
-        } else {
-            s += t;
-        }
-        l = l + 1;
-        counter++;
-    }
-    s += one;
+    mpf_class s(0.0, addprec ? req_precision : _req_precision);
+    scratch_scope scope;
+    mpf_ptr r = scope.get(req_precision, x.get_mpf_t());
+    mpf_ptr _s = scope.get(req_precision);
+    mpf_ptr t = scope.get(req_precision);
+    mpf_mul(r, r, r);
+    mpf_div_2exp(r, r, k * 2);
+    // cos(x / 2^k) = \sum_j (-r)^j / (2j)!
+    mpf_neg(r, r);
+    paterson_stockmeyer(_s, r, [](unsigned long j) { return (2 * j - 1) * (2 * j); });
     for (mp_bitcnt_t i = 0; i < k; i++) {
-        s *= two * s;
-        s -= one;
+        mpf_mul_2exp(t, _s, 1);
+        mpf_mul(_s, _s, t);
+        mpf_sub_ui(_s, _s, 1);
     }
-    if (addprec == true)
-        return s;
-    _s = s; // reduce the precision, may not be necessary but to be sure.
-    return _s;
+    mpf_set(s.get_mpf_t(), _s); // reduces the precision unless addprec
+    return s;
 }
 inline mpf_class cos_taylor(const mpf_class &x) {
     mp_bitcnt_t req_precision = x.get_prec();
 #if defined ___GMPXX_MKII_NOPRECCHANGE___
     assert(req_precision == mpf_get_default_prec());
 #endif
-    mpf_class pi(0.0, req_precision);
-    mpf_class two(2.0, req_precision);
-    mpf_class two_pi(0.0, req_precision);
-    mpf_class pi_over_2(0.0, req_precision);
-    mpf_class x_reduced(0.0, req_precision);
-    mpf_class cosx(0.0, req_precision);
+    const mpf_class pi(const_pi(req_precision));
+    mpf_class x_reduced(x);
     int symm_sign = 1;
-    // Setting some constants
-    pi = const_pi(req_precision);
-    two_pi = two * pi;
-    pi_over_2 = pi / two;
+    scratch_scope scope;
+    mpf_ptr two_pi = scope.get(req_precision);
+    mpf_ptr pi_over_2 = scope.get(req_precision);
+    mpf_mul_2exp(two_pi, pi.get_mpf_t(), 1);
+    mpf_div_2exp(pi_over_2, pi.get_mpf_t(), 1);
     // cos(-x) = cos(x)
-    x_reduced = x;
-    if (x_reduced < 0) {
-        x_reduced = -x_reduced;
-    }
+    mpf_abs(x_reduced.get_mpf_t(), x_reduced.get_mpf_t());
     // Reduce x to [-pi, pi)
-    x_reduced = mpf_remainder(x_reduced + pi, two_pi);
-    if (x_reduced < 0)
-        x_reduced += two_pi;
-    x_reduced -= pi;
+    mpf_add(x_reduced.get_mpf_t(), x_reduced.get_mpf_t(), pi.get_mpf_t());
+    mpf_remainder(x_reduced.get_mpf_t(), x_reduced.get_mpf_t(), two_pi);
+    mpf_sub(x_reduced.get_mpf_t(), x_reduced.get_mpf_t(), pi.get_mpf_t());
     // Furthur reduce x to  [-pi/2, pi/2)
-    if (x_reduced > pi_over_2) {
-        x_reduced = pi - x;
-        symm_sign = -1;
-    } else if (x_reduced < -pi_over_2) {
-        x_reduced = -pi - x_reduced;
+    mpf_neg(pi_over_2, pi_over_2);
+    if (mpf_cmp(x_reduced.get_mpf_t(), pi_over_2) < 0) {
+        mpf_neg(x_reduced.get_mpf_t(), x_reduced.get_mpf_t());
+        mpf_sub(x_reduced.get_mpf_t(), x_reduced.get_mpf_t(), pi.get_mpf_t());
         symm_sign = -1;
+    } else {
+        mpf_neg(pi_over_2, pi_over_2);
+        if (mpf_cmp(x_reduced.get_mpf_t(), pi_over_2) > 0) {
+            mpf_sub(x_reduced.get_mpf_t(), pi.get_mpf_t(), x.get_mpf_t());
+            symm_sign = -1;
+        }
     }
-    cosx = cos_taylor_reduced(x_reduced) * symm_sign;
+    mpf_class cosx = cos_taylor_reduced(x_reduced);
+    if (symm_sign < 0)
+        mpf_neg(cosx.get_mpf_t(), cosx.get_mpf_t());
     return cosx;
 }
-inline mpf_class cos(const mpf_class &x) { return cos_taylor(x); }
+inline mpf_class cos(const mpf_class &x) {
+#if defined ___GMPXX_MKII_ZIV___
+    return ziv_evaluate(x, cos_taylor);
+#else
+    return cos_taylor(x);
+#endif
+}
 // mpf_class cos(const mpf_class &x) { return cos_taylor_naive(x); }
 //  Naive Taylor expansion version. It generates a very long series.
 inline mpf_class sin_taylor_naive(const mpf_class &x) {
@@ -4049,19 +5929,17 @@ inline mpf_class sinx_from_cos_internal(const mpf_class &x, bool addprec = false
         additional_precision = ((k / 64) + 1) * 64;
     }
     mp_bitcnt_t req_precision = _req_precision + additional_precision;
-    mpf_class c(0.0, req_precision);
-    mpf_class t(0.0, req_precision);
-    mpf_class s(0.0, req_precision);
-    mpf_class u(0.0, req_precision);
-    mpf_class one(1.0, req_precision);
-    c = cos_taylor_reduced(x, true);
-    t = c * c;
-    u = one - t;
-    s = sqrt(u);
-    if (addprec)
-        return s;
-    else
-        _s = s;
+    mpf_class c = cos_taylor_reduced(x, true);
+    scratch_scope scope;
+    mpf_ptr t = scope.get(req_precision);
+    mpf_mul(t, c.get_mpf_t(), c.get_mpf_t());
+    mpf_ui_sub(t, 1, t);
+    if (addprec) {
+        mpf_sqrt(c.get_mpf_t(), t);
+        return c;
+    }
+    mpf_sqrt(t, t);
+    mpf_set(_s.get_mpf_t(), t);
     return _s;
 }
 inline mpf_class sin_from_cos(const mpf_class &x) {
@@ -4069,107 +5947,138 @@ inline mpf_class sin_from_cos(const mpf_class &x) {
 #if defined ___GMPXX_MKII_NOPRECCHANGE___
     assert(req_precision == mpf_get_default_prec());
 #endif
-    // Constants and variables
-    mpf_class _PI(0.0, req_precision);
-    mpf_class two_pi(0.0, req_precision);
-    mpf_class pi_over_2(0.0, req_precision);
-    mpf_class x_reduced(0.0, req_precision);
-    mpf_class sinx(0.0, req_precision);
-    mpf_class zero(0.0, req_precision);
-    mpf_class one(1.0, req_precision);
-    mpf_class two(2.0, req_precision);
-    mpf_class three(3.0, req_precision);
-    mpf_class n(0.0, req_precision);
+    const mpf_class _PI(const_pi(req_precision));
+    mpf_class x_reduced(x);
     int symm_sign = 1;
-    // Setting some constants
-    _PI = const_pi(req_precision);
-    two_pi = two * _PI;
-    pi_over_2 = _PI / two;
+    scratch_scope scope;
+    mpf_ptr two_pi = scope.get(req_precision);
+    mpf_ptr pi_over_2 = scope.get(req_precision);
+    mpf_ptr three_two_pi = scope.get(req_precision);
+    mpf_mul_2exp(two_pi, _PI.get_mpf_t(), 1);
+    mpf_div_2exp(pi_over_2, _PI.get_mpf_t(), 1);
+    mpf_mul_ui(three_two_pi, two_pi, 3);
+    mpf_ptr xr = x_reduced.get_mpf_t();
     // sin(-x) = -sin(x)
-    x_reduced = x;
-    if (x_reduced < 0) {
-        x_reduced = -x_reduced;
+    if (mpf_sgn(xr) < 0) {
+        mpf_neg(xr, xr);
         symm_sign = -1;
     }
     // Reduce x to [0, 2pi)
-    x_reduced = mpf_remainder(x_reduced, two_pi);
+    mpf_remainder(xr, xr, two_pi);
     // Furthur reduce x to [0, pi/2)
-    if ((pi_over_2 < x_reduced) && (x_reduced <= _PI)) {
-        x_reduced = _PI - x_reduced;
+    if (mpf_cmp(pi_over_2, xr) < 0 && mpf_cmp(xr, _PI.get_mpf_t()) <= 0) {
+        mpf_sub(xr, _PI.get_mpf_t(), xr);
     }
-    if ((_PI < x_reduced) && (x_reduced <= three * two_pi)) {
-        x_reduced = three * two_pi - x_reduced;
+    if (mpf_cmp(_PI.get_mpf_t(), xr) < 0 && mpf_cmp(xr, three_two_pi) <= 0) {
+        mpf_sub(xr, three_two_pi, xr);
         symm_sign *= -1;
     }
-    if ((three * two_pi < x_reduced) && (x_reduced <= two_pi)) {
-        x_reduced = two_pi - x_reduced;
+    if (mpf_cmp(three_two_pi, xr) < 0 && mpf_cmp(xr, two_pi) <= 0) {
+        mpf_sub(xr, two_pi, xr);
         symm_sign *= -1;
     }
-    sinx = sinx_from_cos_internal(x_reduced);
-    return sinx * symm_sign;
+    mpf_class sinx = sinx_from_cos_internal(x_reduced);
+    if (symm_sign < 0)
+        mpf_neg(sinx.get_mpf_t(), sinx.get_mpf_t());
+    return sinx;
 }
-inline mpf_class sin(const mpf_class &x) { return sin_from_cos(x); }
-inline mpf_class tan_from_sin_cos(const mpf_class &x) {
+inline mpf_class sin(const mpf_class &x) {
+#if defined ___GMPXX_MKII_ZIV___
+    return ziv_evaluate(x, sin_from_cos);
+#else
+    return sin_from_cos(x);
+#endif
+}
+// sin(x) and cos(x) from a single argument reduction and a single Taylor/doubling evaluation
+inline void sincos(const mpf_class &x, mpf_class &sinx, mpf_class &cosx) {
     mp_bitcnt_t req_precision = x.get_prec();
 #if defined ___GMPXX_MKII_NOPRECCHANGE___
     assert(req_precision == mpf_get_default_prec());
 #endif
-    // Constants and variables
-    mpf_class _PI(0.0, req_precision);
-    mpf_class two_pi(0.0, req_precision);
-    mpf_class pi_over_2(0.0, req_precision);
-    mpf_class x_reduced(0.0, req_precision);
-    mpf_class zero(0.0, req_precision);
-    mpf_class one(1.0, req_precision);
-    mpf_class two(2.0, req_precision);
-    mpf_class three(3.0, req_precision);
-    mpf_class n(0.0, req_precision);
-    int symm_sign = 1;
-    // Setting some constants
-    _PI = const_pi(req_precision);
-    two_pi = two * _PI;
-    pi_over_2 = _PI / two;
-    // tan(-x) = -tan(x)
-    x_reduced = x;
-    if (x_reduced < 0) {
+    mpf_class _PI(const_pi(req_precision));
+    mpf_class two_pi(_PI);
+    mpf_class pi_over_2(_PI);
+    mpf_class pi_over_4(_PI);
+    mpf_class x_reduced(x);
+    mpz_class quadrant;
+    two_pi.mul_2exp(1);
+    pi_over_2.div_2exp(1);
+    pi_over_4.div_2exp(2);
+    // sin(-x) = -sin(x), cos(-x) = cos(x)
+    bool negative = x_reduced < 0;
+    if (negative)
         x_reduced = -x_reduced;
-        symm_sign = -1;
-    }
-    // Reduce x to [0, 2pi)
+    // Reduce x to [0, 2pi), then to [0, pi/2) and its quadrant
     x_reduced = mpf_remainder(x_reduced, two_pi);
-    // Furthur reduce x to [0, pi/2)
-    if ((pi_over_2 < x_reduced) && (x_reduced <= _PI)) {
-        x_reduced = _PI - x_reduced;
-    }
-    if ((_PI < x_reduced) && (x_reduced <= three * two_pi)) {
-        x_reduced = three * two_pi - x_reduced;
-        symm_sign *= -1;
-    }
-    if ((three * two_pi < x_reduced) && (x_reduced <= two_pi)) {
-        x_reduced = two_pi - x_reduced;
-        symm_sign *= -1;
-    }
-    // Calculate tan(x) using Taylor series
-    mp_bitcnt_t k = std::floor(std::sqrt(req_precision / 2));
-    // We need some additional precision for successive applications of the double-angle formula
-    mp_bitcnt_t additional_precision = 0;
-    if (k % 64 != 0) {
-        additional_precision = ((k / 64) + 1) * 64;
+    x_reduced = mpf_remainder(x_reduced, pi_over_2, &quadrant);
+    // Furthur reduce x to [0, pi/4] so that cos(x) >= 1/sqrt(2)
+    bool complement = x_reduced > pi_over_4;
+    if (complement)
+        x_reduced = pi_over_2 - x_reduced;
+    mp_exp_t e = 0;
+    mpf_get_d_2exp(&e, x_reduced.get_mpf_t());
+    mpf_class c(cos_taylor_reduced(x_reduced, true));
+    mpf_class s(0.0, c.get_prec());
+    if (e < 0) {
+        // |x| < 1/2: sqrt(1 - cos^2) would cancel about 2 log2(1/x) bits, so sum
+        // sin(x) = \sum_j (-1)^j x^(2j+1) / (2j+1)! itself, with guard bits in both modes
+        mp_bitcnt_t work_precision = req_precision + 64;
+        mpf_class term(x_reduced, work_precision), x2(0.0, work_precision);
+        s = mpf_class(x_reduced, work_precision);
+        mpf_mul(x2.get_mpf_t(), term.get_mpf_t(), term.get_mpf_t());
+        mp_exp_t term_e = e;
+        for (unsigned long j = 1; mpf_sgn(term.get_mpf_t()) != 0 && term_e >= e - static_cast<mp_exp_t>(work_precision); j++) {
+            mpf_mul(term.get_mpf_t(), term.get_mpf_t(), x2.get_mpf_t());
+            mpf_div_ui(term.get_mpf_t(), term.get_mpf_t(), (2 * j) * (2 * j + 1));
+            mpf_neg(term.get_mpf_t(), term.get_mpf_t());
+            mpf_add(s.get_mpf_t(), s.get_mpf_t(), term.get_mpf_t());
+            mpf_get_d_2exp(&term_e, term.get_mpf_t());
+        }
+    } else {
+        mpf_mul(s.get_mpf_t(), c.get_mpf_t(), c.get_mpf_t());
+        mpf_ui_sub(s.get_mpf_t(), 1, s.get_mpf_t());
+        mpf_sqrt(s.get_mpf_t(), s.get_mpf_t());
+    }
+    if (complement)
+        s.swap(c);
+    switch (mpz_fdiv_ui(quadrant.get_mpz_t(), 4)) {
+    case 1:
+        s.swap(c);
+        c = -c;
+        break;
+    case 2:
+        s = -s;
+        c = -c;
+        break;
+    case 3:
+        s.swap(c);
+        s = -s;
+        break;
     }
-    mp_bitcnt_t _req_precision;
-    _req_precision = req_precision + additional_precision;
-    // Constants and variables
-    mpf_class cosx(0.0, _req_precision);
-    mpf_class sinx(0.0, _req_precision);
-    mpf_class tanx(0.0, _req_precision);
-
-    cosx = cos_taylor_reduced(x, true);
-    sinx = sinx_from_cos_internal(x, true);
-    tanx = (sinx / cosx);
-    tanx *= symm_sign;
+    if (negative)
+        s = -s;
+    sinx = mpf_class(s, req_precision);
+    cosx = mpf_class(c, req_precision);
+}
+inline mpf_class tan_from_sin_cos(const mpf_class &x) {
+    mp_bitcnt_t req_precision = x.get_prec();
+#if defined ___GMPXX_MKII_NOPRECCHANGE___
+    assert(req_precision == mpf_get_default_prec());
+#endif
+    mpf_class sinx(0.0, req_precision);
+    mpf_class cosx(0.0, req_precision);
+    mpf_class tanx(0.0, req_precision);
+    sincos(x, sinx, cosx);
+    tanx = sinx / cosx;
     return tanx;
 }
-inline mpf_class tan(const mpf_class &x) { return tan_from_sin_cos(x); }
+inline mpf_class tan(const mpf_class &x) {
+#if defined ___GMPXX_MKII_ZIV___
+    return ziv_evaluate(x, tan_from_sin_cos);
+#else
+    return tan_from_sin_cos(x);
+#endif
+}
 inline mpf_class pow_from_exp_log(const mpf_class &x, const mpf_class &y) {
     mp_bitcnt_t req_precision = x.get_prec();
     mp_bitcnt_t req_precision_y = y.get_prec();
@@ -4211,10 +6120,8 @@ inline mpf_class log2_from_log(const mpf_class &x) {
 #if defined ___GMPXX_MKII_NOPRECCHANGE___
     assert(req_precision == mpf_get_default_prec());
 #endif
-    mpf_class _log2(0.0, req_precision);
     mpf_class result(0.0, req_precision);
-    _log2 = log(mpf_class(2));
-    result = log(x) / _log2;
+    result = log(x) / const_log2(req_precision);
     return result;
 }
 inline mpf_class log2(const mpf_class &x) { return log2_from_log(x); }
@@ -4223,10 +6130,8 @@ inline mpf_class log10_from_log(const mpf_class &x) {
 #if defined ___GMPXX_MKII_NOPRECCHANGE___
     assert(req_precision == mpf_get_default_prec());
 #endif
-    mpf_class _log10(0.0, req_precision);
     mpf_class result(0.0, req_precision);
-    _log10 = log(mpf_class(10));
-    result = log(x) / _log10;
+    result = log(x) / const_log10(req_precision);
     return result;
 }
 inline mpf_class log10(const mpf_class &x) { return log10_from_log(x); }
@@ -4235,56 +6140,84 @@ inline mpf_class atan_AGM(const mpf_class &_x) {
 #if defined ___GMPXX_MKII_NOPRECCHANGE___
     assert(req_precision == mpf_get_default_prec());
 #endif
-    // Constants and variables
-    mpf_class zero(0.0, req_precision);
-    mpf_class one(1.0, req_precision);
-    mpf_class two(2.0, req_precision);
-    mpf_class three(3.0, req_precision);
-    mpf_class four(4.0, req_precision);
-    mpf_class s(2.0, req_precision);
-    mpf_class epsilon(2.0, req_precision);
-    mpf_class x(zero, req_precision);
-    mpf_class v(zero, req_precision);
-    mpf_class q(one, req_precision);
-    mpf_class ai(zero, req_precision);
-    mpf_class bi(one, req_precision);
-    mpf_class ci(zero, req_precision);
-    mpf_class si(one, req_precision);
-    mpf_class vi(one, req_precision);
-    mpf_class qi(one, req_precision);
-    mpf_class atanx(zero, req_precision);
-    mpf_class atanx_refined(zero, req_precision);
+    mpf_class atanx(0.0, req_precision);
+    mpf_class log_arg(0.0, req_precision);
     int sign = 1;
-    int reduce = 1;
-    if (_x < 0) {
-        x = -_x;
+    unsigned long reduce = 1;
+    scratch_scope scope;
+    mpf_ptr x = scope.get(req_precision, _x.get_mpf_t());
+    mpf_ptr epsilon = scope.get(req_precision, 2UL);
+    mpf_ptr ai = scope.get(req_precision);
+    mpf_ptr bi = scope.get(req_precision);
+    mpf_ptr ci = scope.get(req_precision);
+    mpf_ptr si = scope.get(req_precision, 2UL);
+    mpf_ptr vi = scope.get(req_precision);
+    mpf_ptr qi = scope.get(req_precision, 1UL);
+    mpf_ptr t = scope.get(req_precision);
+    mpf_ptr u = scope.get(req_precision);
+    if (mpf_sgn(x) < 0) {
+        mpf_neg(x, x);
         sign = -1;
-    } else
-        x = _x;
-    //
-    if (x >= 1) {
-        x = (sqrt(one + x * x) - one) / x;
-        reduce = 2;
     }
-    s.div_2exp(req_precision / 2);
-    epsilon.div_2exp(req_precision);
-
-    v = x / (one + sqrt(one + x * x));
-    q = one;
-
-    si = s, vi = v, qi = q;
-    while (one - si >= epsilon) {
-        qi = two * qi / (one + si);
-        ai = two * si * vi / (one + vi * vi);
-        bi = ai / (one + sqrt(one - ai * ai));
-        ci = (vi + bi) / (one - vi * bi);
-        vi = ci / (one + sqrt(one + ci * ci));
-        si = two * sqrt(si) / (one + si);
+    // sqrt(1 + x^2)
+    auto hypot1 = [](mpf_ptr rop, mpf_srcptr op) {
+        mpf_mul(rop, op, op);
+        mpf_add_ui(rop, rop, 1);
+        mpf_sqrt(rop, rop);
+    };
+    if (mpf_cmp_ui(x, 1) >= 0) {
+        hypot1(t, x);
+        mpf_sub_ui(t, t, 1);
+        mpf_div(x, t, x);
+        reduce = 2;
     }
-    atanx = qi * log((one + vi) / (one - vi));
-    atanx = atanx * sign * reduce;
-    atanx_refined = atanx - (tan(atanx) - _x) / (one + tan(atanx) * tan(atanx));
-    return atanx_refined;
+    mpf_div_2exp(si, si, req_precision / 2);
+    mpf_div_2exp(epsilon, epsilon, req_precision);
+
+    hypot1(t, x);
+    mpf_add_ui(t, t, 1);
+    mpf_div(vi, x, t);
+    while (mpf_ui_sub(t, 1, si), mpf_cmp(t, epsilon) >= 0) {
+        mpf_mul_2exp(t, qi, 1);
+        mpf_add_ui(u, si, 1);
+        mpf_div(qi, t, u);
+        mpf_mul_2exp(t, si, 1);
+        mpf_mul(t, t, vi);
+        mpf_mul(u, vi, vi);
+        mpf_add_ui(u, u, 1);
+        mpf_div(ai, t, u);
+        mpf_mul(t, ai, ai);
+        mpf_ui_sub(t, 1, t);
+        mpf_sqrt(t, t);
+        mpf_add_ui(t, t, 1);
+        mpf_div(bi, ai, t);
+        mpf_add(t, vi, bi);
+        mpf_mul(u, vi, bi);
+        mpf_ui_sub(u, 1, u);
+        mpf_div(ci, t, u);
+        hypot1(t, ci);
+        mpf_add_ui(t, t, 1);
+        mpf_div(vi, ci, t);
+        mpf_sqrt(t, si);
+        mpf_mul_2exp(t, t, 1);
+        mpf_add_ui(u, si, 1);
+        mpf_div(si, t, u);
+    }
+    mpf_add_ui(t, vi, 1);
+    mpf_ui_sub(u, 1, vi);
+    mpf_div(log_arg.get_mpf_t(), t, u);
+    mpf_mul(atanx.get_mpf_t(), qi, log(log_arg).get_mpf_t());
+    if (sign < 0)
+        mpf_neg(atanx.get_mpf_t(), atanx.get_mpf_t());
+    mpf_mul_ui(atanx.get_mpf_t(), atanx.get_mpf_t(), reduce);
+    // One Newton step for tan(y) = x: y - (tan(y) - x) / (1 + tan(y)^2) = y - cos(y) (sin(y) - x cos(y))
+    mpf_class sin_atanx(0.0, req_precision), cos_atanx(0.0, req_precision);
+    sincos(atanx, sin_atanx, cos_atanx);
+    mpf_mul(t, _x.get_mpf_t(), cos_atanx.get_mpf_t());
+    mpf_sub(t, sin_atanx.get_mpf_t(), t);
+    mpf_mul(t, cos_atanx.get_mpf_t(), t);
+    mpf_sub(atanx.get_mpf_t(), atanx.get_mpf_t(), t);
+    return atanx;
 }
 inline mpf_class atan2(const mpf_class &y, const mpf_class &x) {
     mp_bitcnt_t req_precision = x.get_prec();
@@ -4349,7 +6282,13 @@ inline mpf_class atan2(const mpf_class &y, const mpf_class &x) {
         return atan_AGM(y / x) - pi_;
     }
 }
-inline mpf_class atan(const mpf_class &x) { return atan_AGM(x); }
+inline mpf_class atan(const mpf_class &x) {
+#if defined ___GMPXX_MKII_ZIV___
+    return ziv_evaluate(x, atan_AGM);
+#else
+    return atan_AGM(x);
+#endif
+}
 inline mpf_class asin_AGM(const mpf_class &x) {
     if (x < -1 || x > 1) {
         throw std::out_of_range("Error: x must be between -1 and 1.");
@@ -4371,7 +6310,9 @@ inline mpf_class asin_AGM(const mpf_class &x) {
     mpf_class sqrt_one_minus_x2(0.0, req_precision);
     sqrt_one_minus_x2 = sqrt(one - x * x);
     result = atan_AGM(x / sqrt_one_minus_x2);
-    asin_refined = result - (sin(result) - x) / cos(result);
+    mpf_class sin_result(0.0, req_precision), cos_result(0.0, req_precision);
+    sincos(result, sin_result, cos_result);
+    asin_refined = result - (sin_result - x) / cos_result;
     return asin_refined;
 }
 
@@ -4382,61 +6323,68 @@ inline mpf_class arcsin_taylor(const mpf_class &x) {
 #if defined ___GMPXX_MKII_NOPRECCHANGE___
     assert(req_precision == mpf_get_default_prec());
 #endif
-    mpf_class abs_x(0.0, req_precision);
-    mpf_class term(0.0, req_precision);
-    mpf_class arcsin_x(0.0, req_precision);
-    mpf_class arcsin_x_prev(0.0, req_precision);
-    mpf_class fact_2n(1.0, req_precision);
-    mpf_class fact_n(1.0, req_precision);
-    mpf_class pow_4n(1.0, req_precision);
-    mpf_class two_n_plus_one(1.0, req_precision);
-    mpf_class x_pow_2n_plus_1(0.0, req_precision);
-    mpf_class epsilon(2.0, req_precision);
-    mpf_class n(0.0, req_precision);
-
-    mpf_class zero(0.0, req_precision);
-    mpf_class quarter(0.25, req_precision);
-    mpf_class one(1.0, req_precision);
-    mpf_class two(2.0, req_precision);
-    mpf_class four(4.0, req_precision);
-
-    mpf_class pi_over_2(1.0, req_precision);
-    mpf_class half(0.5, req_precision);
-    pi_over_2 = const_pi(req_precision) * half;
-    if (x == -1)
-        return -pi_over_2;
-    if (x == 1)
+    if (x == -1 || x == 1) {
+        mpf_class pi_over_2(const_pi(req_precision), req_precision);
+        mpf_div_2exp(pi_over_2.get_mpf_t(), pi_over_2.get_mpf_t(), 1);
+        if (x == -1)
+            mpf_neg(pi_over_2.get_mpf_t(), pi_over_2.get_mpf_t());
         return pi_over_2;
-
-    bool negative = false;
-    abs_x = x;
-    if (x < 0) {
-        negative = true;
-        abs_x = -x;
     }
-    term = abs_x;
-    epsilon.div_2exp(req_precision);
-
-    x_pow_2n_plus_1 = abs_x;                             // x^(2n+1)
+    mpf_class arcsin_x(0.0, req_precision);
+    scratch_scope scope;
+    mpf_ptr abs_x = scope.get(req_precision, x.get_mpf_t());
+    mpf_ptr x2 = scope.get(req_precision);
+    mpf_ptr term = scope.get(req_precision);
+    mpf_ptr arcsin_x_prev = scope.get(req_precision);
+    mpf_ptr fact_2n = scope.get(req_precision, 1UL);
+    mpf_ptr fact_n = scope.get(req_precision, 1UL);
+    mpf_ptr pow_4n = scope.get(req_precision, 1UL);
+    mpf_ptr x_pow_2n_plus_1 = scope.get(req_precision);
+    mpf_ptr epsilon = scope.get(req_precision, 2UL);
+    mpf_ptr t = scope.get(req_precision);
+    mpf_ptr u = scope.get(req_precision);
+
+    bool negative = mpf_sgn(abs_x) < 0;
+    mpf_abs(abs_x, abs_x);
+    mpf_mul(x2, abs_x, abs_x);
+    mpf_set(term, abs_x);
+    mpf_div_2exp(epsilon, epsilon, req_precision);
+
+    mpf_set(x_pow_2n_plus_1, abs_x);                      // x^(2n+1)
     for (mp_bitcnt_t _n = 0; _n < req_precision; ++_n) { // |x| \sim 1 there is a serious convergence problem
         if (_n > 0) {
-            n = mpf_class(_n);
-            fact_2n *= (two * n) * (two * n - one);
-            fact_n *= n;
-            pow_4n *= four;
-            two_n_plus_one = two * n + one;
-            x_pow_2n_plus_1 *= abs_x * abs_x;
-            term = (fact_2n / (pow_4n * fact_n * fact_n * two_n_plus_one)) * x_pow_2n_plus_1;
+            mpf_set_ui(t, 2 * _n);
+            mpf_sub_ui(u, t, 1);
+            mpf_mul(t, t, u);
+            mpf_mul(fact_2n, fact_2n, t);
+            mpf_mul_ui(fact_n, fact_n, _n);
+            mpf_mul_2exp(pow_4n, pow_4n, 2);
+            mpf_mul(x_pow_2n_plus_1, x_pow_2n_plus_1, x2);
+            mpf_mul(t, pow_4n, fact_n);
+            mpf_mul(t, t, fact_n);
+            mpf_mul_ui(t, t, 2 * _n + 1);
+            mpf_div(t, fact_2n, t);
+            mpf_mul(term, t, x_pow_2n_plus_1);
         }
-        arcsin_x_prev = arcsin_x;
-        arcsin_x += term;
-        if (abs(arcsin_x - arcsin_x_prev) < epsilon) {
+        mpf_set(arcsin_x_prev, arcsin_x.get_mpf_t());
+        mpf_add(arcsin_x.get_mpf_t(), arcsin_x.get_mpf_t(), term);
+        mpf_sub(t, arcsin_x.get_mpf_t(), arcsin_x_prev);
+        mpf_abs(t, t);
+        if (mpf_cmp(t, epsilon) < 0) {
             break;
         }
     }
-    return negative ? -arcsin_x : arcsin_x;
+    if (negative)
+        mpf_neg(arcsin_x.get_mpf_t(), arcsin_x.get_mpf_t());
+    return arcsin_x;
+}
+inline mpf_class asin(const mpf_class &x) {
+#if defined ___GMPXX_MKII_ZIV___
+    return ziv_evaluate(x, asin_AGM);
+#else
+    return asin_AGM(x);
+#endif
 }
-inline mpf_class asin(const mpf_class &x) { return asin_AGM(x); }
 inline mpf_class acos(const mpf_class &x) {
     mp_bitcnt_t req_precision = x.get_prec();
 #if defined ___GMPXX_MKII_NOPRECCHANGE___
@@ -4448,16 +6396,67 @@ inline mpf_class acos(const mpf_class &x) {
     acosx = half_pi - asin(x);
     return acosx;
 }
+// sinh(x) = x \sum_j x^(2j) / (2j+1)!, free of the cancellation in exp(x) - exp(-x) for small |x|
+inline mpf_class sinh_taylor(const mpf_class &x) {
+    mp_bitcnt_t req_precision = x.get_prec();
+#if defined ___GMPXX_MKII_NOPRECCHANGE___
+    assert(req_precision == mpf_get_default_prec());
+#endif
+    mpf_class x2(0.0, req_precision);
+    mpf_class sinh_x(0.0, req_precision);
+    mpf_mul(x2.get_mpf_t(), x.get_mpf_t(), x.get_mpf_t());
+    sinh_x = paterson_stockmeyer(x2, [](unsigned long j) { return (2 * j) * (2 * j + 1); });
+    mpf_mul(sinh_x.get_mpf_t(), sinh_x.get_mpf_t(), x.get_mpf_t());
+    return sinh_x;
+}
+// exp(x) - exp(-x) cancels about log2(1/|x|) bits; below this bound the series is used
+inline bool sinh_use_taylor(const mpf_class &x) {
+    mp_exp_t e = 0;
+    mpf_get_d_2exp(&e, x.get_mpf_t());
+    return mpf_sgn(x.get_mpf_t()) == 0 || e < 0; // |x| < 1/2
+}
+// sinh(x) and cosh(x) from a single exp(x); exp(-x) is its reciprocal
+inline void sinhcosh(const mpf_class &x, mpf_class &sinh_x, mpf_class &cosh_x) {
+    mp_bitcnt_t req_precision = x.get_prec();
+#if defined ___GMPXX_MKII_NOPRECCHANGE___
+    assert(req_precision == mpf_get_default_prec());
+#endif
+    mpf_class s(0.0, req_precision);
+    mpf_class c(0.0, req_precision);
+    if (sinh_use_taylor(x)) {
+        // cosh(x) = sqrt(1 + sinh(x)^2)
+        s = sinh_taylor(x);
+        mpf_mul(c.get_mpf_t(), s.get_mpf_t(), s.get_mpf_t());
+        mpf_add_ui(c.get_mpf_t(), c.get_mpf_t(), 1);
+        mpf_sqrt(c.get_mpf_t(), c.get_mpf_t());
+    } else {
+        mpf_class exp_x(0.0, req_precision);
+        mpf_class exp_neg_x(0.0, req_precision);
+        exp_x = exp(x);
+        mpf_ui_div(exp_neg_x.get_mpf_t(), 1, exp_x.get_mpf_t());
+        mpf_sub(s.get_mpf_t(), exp_x.get_mpf_t(), exp_neg_x.get_mpf_t());
+        mpf_add(c.get_mpf_t(), exp_x.get_mpf_t(), exp_neg_x.get_mpf_t());
+        mpf_div_2exp(s.get_mpf_t(), s.get_mpf_t(), 1);
+        mpf_div_2exp(c.get_mpf_t(), c.get_mpf_t(), 1);
+    }
+    sinh_x = s;
+    cosh_x = c;
+}
 inline mpf_class sinh(const mpf_class &x) {
     mp_bitcnt_t req_precision = x.get_prec();
 #if defined ___GMPXX_MKII_NOPRECCHANGE___
     assert(req_precision == mpf_get_default_prec());
 #endif
+    if (sinh_use_taylor(x))
+        return sinh_taylor(x);
     mpf_class exp_x(0.0, req_precision);
     mpf_class exp_neg_x(0.0, req_precision);
+    mpf_class sinh_x(0.0, req_precision);
     exp_x = exp(x);
-    exp_neg_x = exp(-x);
-    return (exp_x - exp_neg_x) / 2;
+    mpf_ui_div(exp_neg_x.get_mpf_t(), 1, exp_x.get_mpf_t());
+    mpf_sub(sinh_x.get_mpf_t(), exp_x.get_mpf_t(), exp_neg_x.get_mpf_t());
+    mpf_div_2exp(sinh_x.get_mpf_t(), sinh_x.get_mpf_t(), 1);
+    return sinh_x;
 }
 inline mpf_class cosh(const mpf_class &x) {
     mp_bitcnt_t req_precision = x.get_prec();
@@ -4465,10 +6464,12 @@ inline mpf_class cosh(const mpf_class &x) {
     assert(req_precision == mpf_get_default_prec());
 #endif
     mpf_class exp_x(0.0, req_precision);
-    mpf_class exp_neg_x(0.0, req_precision);
+    mpf_class cosh_x(0.0, req_precision);
     exp_x = exp(x);
-    exp_neg_x = exp(-x);
-    return (exp_x + exp_neg_x) / 2;
+    mpf_ui_div(cosh_x.get_mpf_t(), 1, exp_x.get_mpf_t());
+    mpf_add(cosh_x.get_mpf_t(), cosh_x.get_mpf_t(), exp_x.get_mpf_t());
+    mpf_div_2exp(cosh_x.get_mpf_t(), cosh_x.get_mpf_t(), 1);
+    return cosh_x;
 }
 inline mpf_class tanh(const mpf_class &x) {
     mp_bitcnt_t req_precision = x.get_prec();
@@ -4477,8 +6478,7 @@ inline mpf_class tanh(const mpf_class &x) {
 #endif
     mpf_class sinh_x(0.0, req_precision);
     mpf_class cosh_x(0.0, req_precision);
-    sinh_x = sinh(x);
-    cosh_x = cosh(x);
+    sinhcosh(x, sinh_x, cosh_x);
     return sinh_x / cosh_x;
 }
 inline mpf_class asinh(const mpf_class &x) {
@@ -4591,6 +6591,25 @@ class gmp_randclass {
         }
     }
 }; // gmp_randclass
+
+#if defined _OPENMP
+// OpenMP reductions: reduction(+ : x), reduction(* : x), reduction(min : x) and reduction(max : x)
+// for mpz_class, mpq_class and mpf_class x. The private copies of an mpf_class start at the
+// precision of x, and the partial results are combined by the OpenMP runtime (a tree with libgomp)
+// instead of a critical section.
+#pragma omp declare reduction(+ : mpz_class : omp_out += omp_in) initializer(omp_priv = mpz_class(0))
+#pragma omp declare reduction(* : mpz_class : omp_out *= omp_in) initializer(omp_priv = mpz_class(1))
+#pragma omp declare reduction(min : mpz_class : omp_out = omp_in < omp_out ? omp_in : omp_out) initializer(omp_priv = omp_orig)
+#pragma omp declare reduction(max : mpz_class : omp_out = omp_in > omp_out ? omp_in : omp_out) initializer(omp_priv = omp_orig)
+#pragma omp declare reduction(+ : mpq_class : omp_out += omp_in) initializer(omp_priv = mpq_class(0))
+#pragma omp declare reduction(* : mpq_class : omp_out *= omp_in) initializer(omp_priv = mpq_class(1))
+#pragma omp declare reduction(min : mpq_class : omp_out = omp_in < omp_out ? omp_in : omp_out) initializer(omp_priv = omp_orig)
+#pragma omp declare reduction(max : mpq_class : omp_out = omp_in > omp_out ? omp_in : omp_out) initializer(omp_priv = omp_orig)
+#pragma omp declare reduction(+ : mpf_class : omp_out += omp_in) initializer(omp_priv = mpf_class(0, omp_orig.get_prec()))
+#pragma omp declare reduction(* : mpf_class : omp_out *= omp_in) initializer(omp_priv = mpf_class(1, omp_orig.get_prec()))
+#pragma omp declare reduction(min : mpf_class : omp_out = omp_in < omp_out ? omp_in : omp_out) initializer(omp_priv = omp_orig)
+#pragma omp declare reduction(max : mpf_class : omp_out = omp_in > omp_out ? omp_in : omp_out) initializer(omp_priv = omp_orig)
+#endif
 #if !defined ___GMPXX_DONT_USE_NAMESPACE___
 } // namespace gmp
 #endif
@@ -0,0 +1,756 @@
+/*
+ * Copyright (c) 2024
+ *      Nakata, Maho
+ *      All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+
+// Level 1-3 BLAS routines on mpf_class arrays: Rdot (and the exactly summed Rdot_exact), Raxpy,
+// Rgemv and Rgemm (and the cache-blocked Rgemm_packed and the recursive Rgemm_strassen) with the
+// argument conventions of the reference BLAS (column-major matrices, leading dimensions, negative
+// increments, "N"/"T"/"C" transposes). The kernels are the fastest of the benchmarks/0x_*
+// variants: products go through addmul, so the inner loops do not allocate.
+// When compiled with OpenMP, calls with at least blas::defaults::parallel_threshold
+// multiply-adds run in a parallel region; results do not depend on the schedule for a fixed
+// number of threads.
+
+#ifndef ___GMPXX_MKII_BLAS_H___
+#define ___GMPXX_MKII_BLAS_H___
+
+#include "gmpxx_mkII.h"
+#include <cctype>
+#include <cstdint>
+#include <deque>
+#include <string>
+#if defined _OPENMP
+#include <omp.h>
+#endif
+
+#if !defined ___GMPXX_DONT_USE_NAMESPACE___
+namespace gmpxx {
+#endif
+namespace blas {
+
+struct defaults {
+    // fewest multiply-adds for which a routine starts an OpenMP parallel region
+    inline static int64_t parallel_threshold = 4096;
+    // cache sizes the blocking of Rgemm_packed is derived from
+    inline static int64_t l1_cache_bytes = 32 * 1024;
+    inline static int64_t l2_cache_bytes = 512 * 1024;
+    // Rgemm_strassen multiplies with Rgemm_packed once a dimension is at most strassen_crossover
+    inline static int64_t strassen_crossover = 32;
+    // bits added to the precision of C for the intermediate results of Rgemm_strassen; each level
+    // of the recursion loses up to about log2(12) bits, so one limb covers deep recursions
+    inline static mp_bitcnt_t strassen_guard_bits = 64;
+    // called at every leaf product of Rgemm_strassen, from the thread that computes it; for testing
+    inline static void (*strassen_leaf_hook)() = nullptr;
+};
+
+inline bool lsame(const char *a, char b) { return std::toupper(static_cast<unsigned char>(*a)) == b; }
+inline void xerbla(const char *srname, int info) { throw std::invalid_argument(std::string(srname) + ": parameter " + std::to_string(info) + " had an illegal value"); }
+// offset of the first element of a vector of n elements with increment inc
+inline int64_t first_index(int64_t n, int64_t inc) { return inc < 0 ? (1 - n) * inc : 0; }
+
+inline bool run_parallel(int64_t work) {
+#if defined _OPENMP
+    return work >= defaults::parallel_threshold && omp_get_max_threads() > 1 && !omp_in_parallel();
+#else
+    (void)work;
+    return false;
+#endif
+}
+inline int max_threads() {
+#if defined _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+// [begin, end) is the share of the calling thread of n items split evenly over the team
+inline void thread_range(int64_t n, int64_t &begin, int64_t &end) {
+#if defined _OPENMP
+    int64_t parts = omp_get_num_threads(), part = omp_get_thread_num();
+    begin = n * part / parts;
+    end = n * (part + 1) / parts;
+#else
+    begin = 0;
+    end = n;
+#endif
+}
+inline int thread_num() {
+#if defined _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+// y := beta * y on leny elements; beta == 0 clears y without reading it
+inline void scale(int64_t leny, const mpf_class &beta, mpf_class *y, int64_t incy) {
+    if (beta == 1)
+        return;
+    const int64_t ky = first_index(leny, incy);
+    const bool zero = beta == 0;
+#if defined _OPENMP
+#pragma omp parallel for schedule(static) if (run_parallel(leny))
+#endif
+    for (int64_t i = 0; i < leny; ++i) {
+        if (zero)
+            y[ky + i * incy] = 0;
+        else
+            y[ky + i * incy] *= beta;
+    }
+}
+
+// dx^T dy with the default precision; the OpenMP variant sums per-thread partial sums in thread order
+inline mpf_class Rdot(int64_t n, const mpf_class *dx, int64_t incx, const mpf_class *dy, int64_t incy) {
+    mpf_class result;
+    if (n <= 0)
+        return result;
+    const int64_t kx = first_index(n, incx), ky = first_index(n, incy);
+    if (!run_parallel(n)) {
+        for (int64_t i = 0; i < n; ++i)
+            addmul(result, dx[kx + i * incx], dy[ky + i * incy]);
+        return result;
+    }
+    std::vector<mpf_class> partial(max_threads());
+#if defined _OPENMP
+#pragma omp parallel
+#endif
+    {
+        int64_t begin, end;
+        thread_range(n, begin, end);
+        mpf_class &sum = partial[thread_num()];
+        for (int64_t i = begin; i < end; ++i)
+            addmul(sum, dx[kx + i * incx], dy[ky + i * incy]);
+    }
+    for (const mpf_class &sum : partial)
+        result += sum;
+    return result;
+}
+
+// dx^T dy summed exactly (mpf_exact_accumulator) and truncated once to prec bits; the result is the
+// same for any number of threads
+inline mpf_class Rdot_exact(int64_t n, const mpf_class *dx, int64_t incx, const mpf_class *dy, int64_t incy, mp_bitcnt_t prec = mpf_get_default_prec()) {
+    if (n <= 0)
+        return mpf_class(0, prec);
+    const int64_t kx = first_index(n, incx), ky = first_index(n, incy);
+    std::vector<mpf_exact_accumulator> partial(run_parallel(n) ? max_threads() : 1);
+#if defined _OPENMP
+#pragma omp parallel if (partial.size() > 1)
+#endif
+    {
+        int64_t begin, end;
+        thread_range(n, begin, end);
+        mpf_exact_accumulator &sum = partial[thread_num()];
+        for (int64_t i = begin; i < end; ++i)
+            sum.addmul(dx[kx + i * incx], dy[ky + i * incy]);
+    }
+    for (size_t i = 1; i < partial.size(); ++i)
+        partial[0] += partial[i];
+    return partial[0].get(prec);
+}
+
+// dy := alpha * dx + dy
+inline void Raxpy(int64_t n, const mpf_class &alpha, const mpf_class *dx, int64_t incx, mpf_class *dy, int64_t incy) {
+    if (n <= 0 || alpha == 0)
+        return;
+    const int64_t kx = first_index(n, incx), ky = first_index(n, incy);
+#if defined _OPENMP
+#pragma omp parallel for schedule(static) if (run_parallel(n))
+#endif
+    for (int64_t i = 0; i < n; ++i)
+        addmul(dy[ky + i * incy], alpha, dx[kx + i * incx]);
+}
+
+// y := alpha * A * x + beta * y (trans "N") or y := alpha * A^T * x + beta * y (trans "T" or "C"),
+// A is m x n. "N" splits the rows of y over the threads, "T" the columns of A.
+inline void Rgemv(const char *trans, int64_t m, int64_t n, const mpf_class &alpha, const mpf_class *A, int64_t lda, const mpf_class *x, int64_t incx, const mpf_class &beta, mpf_class *y, int64_t incy) {
+    int info = 0;
+    if (!lsame(trans, 'N') && !lsame(trans, 'T') && !lsame(trans, 'C'))
+        info = 1;
+    else if (m < 0)
+        info = 2;
+    else if (n < 0)
+        info = 3;
+    else if (lda < std::max<int64_t>(1, m))
+        info = 6;
+    else if (incx == 0)
+        info = 8;
+    else if (incy == 0)
+        info = 11;
+    if (info != 0)
+        xerbla("Rgemv", info);
+    if (m == 0 || n == 0 || (alpha == 0 && beta == 1))
+        return;
+
+    const bool notrans = lsame(trans, 'N');
+    const int64_t lenx = notrans ? n : m, leny = notrans ? m : n;
+    const int64_t kx = first_index(lenx, incx), ky = first_index(leny, incy);
+    scale(leny, beta, y, incy);
+    if (alpha == 0)
+        return;
+    if (notrans) {
+#if defined _OPENMP
+#pragma omp parallel if (run_parallel(m * n))
+#endif
+        {
+            int64_t begin, end;
+            thread_range(m, begin, end);
+            mpf_class temp;
+            for (int64_t j = 0; j < n; ++j) {
+                temp = alpha;
+                temp *= x[kx + j * incx];
+                for (int64_t i = begin; i < end; ++i)
+                    addmul(y[ky + i * incy], temp, A[i + j * lda]);
+            }
+        }
+    } else {
+#if defined _OPENMP
+#pragma omp parallel if (run_parallel(m * n))
+#endif
+        {
+            mpf_class temp;
+#if defined _OPENMP
+#pragma omp for schedule(static)
+#endif
+            for (int64_t j = 0; j < n; ++j) {
+                temp = 0;
+                for (int64_t i = 0; i < m; ++i)
+                    addmul(temp, A[i + j * lda], x[kx + i * incx]);
+                addmul(y[ky + j * incy], alpha, temp);
+            }
+        }
+    }
+}
+
+// argument checks of the reference xGEMM
+inline void gemm_check(const char *srname, const char *transa, const char *transb, int64_t m, int64_t n, int64_t k, int64_t lda, int64_t ldb, int64_t ldc) {
+    const bool nota = lsame(transa, 'N'), notb = lsame(transb, 'N');
+    const int64_t nrowa = nota ? m : k, nrowb = notb ? k : n;
+    int info = 0;
+    if (!nota && !lsame(transa, 'T') && !lsame(transa, 'C'))
+        info = 1;
+    else if (!notb && !lsame(transb, 'T') && !lsame(transb, 'C'))
+        info = 2;
+    else if (m < 0)
+        info = 3;
+    else if (n < 0)
+        info = 4;
+    else if (k < 0)
+        info = 5;
+    else if (lda < std::max<int64_t>(1, nrowa))
+        info = 8;
+    else if (ldb < std::max<int64_t>(1, nrowb))
+        info = 10;
+    else if (ldc < std::max<int64_t>(1, m))
+        info = 13;
+    if (info != 0)
+        xerbla(srname, info);
+}
+
+// C := alpha * op(A) * op(B) + beta * C with op(X) = X ("N") or X^T ("T" or "C"); op(A) is
+// m x k, op(B) is k x n and C is m x n. The columns of C are split over the threads.
+inline void Rgemm(const char *transa, const char *transb, int64_t m, int64_t n, int64_t k, const mpf_class &alpha, const mpf_class *A, int64_t lda, const mpf_class *B, int64_t ldb, const mpf_class &beta, mpf_class *C, int64_t ldc) {
+    gemm_check("Rgemm", transa, transb, m, n, k, lda, ldb, ldc);
+    if (m == 0 || n == 0 || ((alpha == 0 || k == 0) && beta == 1))
+        return;
+
+    const bool nota = lsame(transa, 'N'), notb = lsame(transb, 'N');
+    const bool beta_one = beta == 1, beta_zero = beta == 0, product = alpha != 0 && k != 0;
+#if defined _OPENMP
+#pragma omp parallel if (run_parallel(m * n * std::max<int64_t>(k, 1)))
+#endif
+    {
+        mpf_class temp;
+#if defined _OPENMP
+#pragma omp for schedule(static)
+#endif
+        for (int64_t j = 0; j < n; ++j) {
+            mpf_class *c = C + j * ldc;
+            if (beta_zero) {
+                for (int64_t i = 0; i < m; ++i)
+                    c[i] = 0;
+            } else if (!beta_one) {
+                for (int64_t i = 0; i < m; ++i)
+                    c[i] *= beta;
+            }
+            if (!product)
+                continue;
+            if (nota) {
+                // c += (alpha * op(B)(l, j)) * A(:, l)
+                for (int64_t l = 0; l < k; ++l) {
+                    temp = alpha;
+                    temp *= notb ? B[l + j * ldb] : B[j + l * ldb];
+                    const mpf_class *a = A + l * lda;
+                    for (int64_t i = 0; i < m; ++i)
+                        addmul(c[i], temp, a[i]);
+                }
+            } else {
+                // c(i) += alpha * (A(:, i) . op(B)(:, j))
+                for (int64_t i = 0; i < m; ++i) {
+                    const mpf_class *a = A + i * lda;
+                    temp = 0;
+                    for (int64_t l = 0; l < k; ++l)
+                        addmul(temp, a[l], notb ? B[l + j * ldb] : B[j + l * ldb]);
+                    addmul(c[i], alpha, temp);
+                }
+            }
+        }
+    }
+}
+
+// Operand panels of Rgemm_packed. Every element is stored as a mantissa of l limbs (truncated or
+// zero padded, most significant limb at the top), its sign and the number of limbs its exponent lies
+// below the largest exponent of its row of op(A) or column of op(B).
+struct gemm_panel {
+    mp_size_t l = 0;
+    std::vector<mp_limb_t> limbs;
+    std::vector<int32_t> shift;
+    std::vector<signed char> sign;
+
+    void resize(size_t count, mp_size_t limbs_per_element) {
+        l = limbs_per_element;
+        limbs.resize(count * l);
+        shift.resize(count);
+        sign.resize(count);
+    }
+    void set_zero(size_t idx) { sign[idx] = 0; }
+    void set(size_t idx, const mpf_class &x, mp_exp_t max_exp) {
+        mpf_srcptr f = x.get_mpf_t();
+        mp_size_t size = std::abs(f->_mp_size), used = std::min(size, l);
+        sign[idx] = f->_mp_size > 0 ? 1 : (f->_mp_size < 0 ? -1 : 0);
+        if (size == 0)
+            return;
+        // shifts of 2l limbs or more move every product out of the accumulator
+        shift[idx] = static_cast<int32_t>(std::min<mp_exp_t>(max_exp - f->_mp_exp, 2 * l));
+        mp_limb_t *d = &limbs[idx * l];
+        std::fill(d, d + l - used, mp_limb_t(0));
+        std::copy(f->_mp_d + size - used, f->_mp_d + size, d + l - used);
+    }
+};
+
+// mr x nr tile of the accumulators: acc(i, j) += sum over l of a(i, l) * b(l, j) on kb terms of the packed
+// micro-panels a (mr elements per l) and b (nr elements per l). The accumulators are two's complement
+// numbers of 2 l + 1 limbs whose least significant limb has the weight of the product of the largest
+// elements of row i and column j, so a product lands shifted down by the sum of the two shifts.
+inline void gemm_micro_kernel(int64_t kb, int64_t mr, int64_t nr, const gemm_panel &ap, size_t a0, const gemm_panel &bp, size_t b0, mp_limb_t *acc, int64_t ldacc, mp_limb_t *product) {
+    const mp_size_t l = ap.l, w = 2 * l + 1;
+    for (int64_t p = 0; p < kb; ++p) {
+        for (int64_t jj = 0; jj < nr; ++jj) {
+            const size_t b = b0 + p * nr + jj;
+            if (bp.sign[b] == 0)
+                continue;
+            for (int64_t ii = 0; ii < mr; ++ii) {
+                const size_t a = a0 + p * mr + ii;
+                if (ap.sign[a] == 0)
+                    continue;
+                const int32_t drop = ap.shift[a] + bp.shift[b];
+                if (drop >= 2 * l)
+                    continue;
+                mpn_mul_n(product, &ap.limbs[a * l], &bp.limbs[b * l], l);
+                mp_limb_t *c = acc + (ii + jj * ldacc) * w;
+                if (ap.sign[a] == bp.sign[b])
+                    mpn_add(c, c, w, product + drop, 2 * l - drop);
+                else
+                    mpn_sub(c, c, w, product + drop, 2 * l - drop);
+            }
+        }
+    }
+}
+
+// Rgemm on packed operands: op(A) and op(B) are copied block by block into contiguous limb panels
+// (gemm_panel) and multiplied by gemm_micro_kernel with mpn_mul_n and mpn_add/mpn_sub into fixed
+// point accumulators, which are rounded once into C. The kc x nr panel of B and the mr x kc panel
+// of A used by one micro-kernel call fit defaults::l1_cache_bytes, the mc x kc block of A fits
+// defaults::l2_cache_bytes. The elements keep l limbs, the larger of the limbs of the working
+// precision (that of alpha or of any element of C) and max |_mp_size| of op(A) and op(B), and every
+// product is kept to 2 l limbs below the largest product of its row and column. An element of C
+// whose row of op(A) and column of op(B) together span more than l limbs of exponents could lose
+// products below that window, so it is computed by Rgemm instead. max_limbs truncates the elements
+// further.
+inline void Rgemm_packed(const char *transa, const char *transb, int64_t m, int64_t n, int64_t k, const mpf_class &alpha, const mpf_class *A, int64_t lda, const mpf_class *B, int64_t ldb, const mpf_class &beta, mpf_class *C, int64_t ldc, mp_size_t max_limbs = std::numeric_limits<mp_size_t>::max()) {
+    gemm_check("Rgemm_packed", transa, transb, m, n, k, lda, ldb, ldc);
+    if (m == 0 || n == 0 || ((alpha == 0 || k == 0) && beta == 1))
+        return;
+    if (alpha == 0 || k == 0) {
+        Rgemm(transa, transb, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+        return;
+    }
+    const bool nota = lsame(transa, 'N'), notb = lsame(transb, 'N');
+    auto opa = [&](int64_t i, int64_t p) -> const mpf_class & { return nota ? A[i + p * lda] : A[p + i * lda]; };
+    auto opb = [&](int64_t p, int64_t j) -> const mpf_class & { return notb ? B[p + j * ldb] : B[j + p * ldb]; };
+
+    const mp_exp_t none = std::numeric_limits<mp_exp_t>::min() / 4;
+    std::vector<mp_exp_t> row_exp(m, none), col_exp(n, none), row_span(m, 0), col_span(n, 0);
+    std::vector<mp_exp_t> row_min(m, std::numeric_limits<mp_exp_t>::max()), col_min(n, std::numeric_limits<mp_exp_t>::max());
+    mp_bitcnt_t prec = alpha.get_prec();
+    for (int64_t j = 0; j < n; ++j)
+        for (int64_t i = 0; i < m; ++i)
+            prec = std::max(prec, C[i + j * ldc].get_prec());
+    mp_size_t l = static_cast<mp_size_t>((prec + GMP_NUMB_BITS - 1) / GMP_NUMB_BITS);
+    for (int64_t p = 0; p < k; ++p) {
+        for (int64_t i = 0; i < m; ++i) {
+            mpf_srcptr f = opa(i, p).get_mpf_t();
+            if (f->_mp_size != 0) {
+                row_exp[i] = std::max(row_exp[i], f->_mp_exp);
+                row_min[i] = std::min(row_min[i], f->_mp_exp);
+                l = std::max<mp_size_t>(l, std::abs(f->_mp_size));
+            }
+        }
+        for (int64_t j = 0; j < n; ++j) {
+            mpf_srcptr f = opb(p, j).get_mpf_t();
+            if (f->_mp_size != 0) {
+                col_exp[j] = std::max(col_exp[j], f->_mp_exp);
+                col_min[j] = std::min(col_min[j], f->_mp_exp);
+                l = std::max<mp_size_t>(l, std::abs(f->_mp_size));
+            }
+        }
+    }
+    l = std::max<mp_size_t>(1, std::min(l, max_limbs));
+    // every product of C(i, j) keeps at least l limbs, as in Rgemm, unless the spans of row i and
+    // column j add up to more than l limbs; those elements are left to Rgemm below
+    for (int64_t i = 0; i < m; ++i)
+        if (row_exp[i] != none)
+            row_span[i] = row_exp[i] - row_min[i];
+    for (int64_t j = 0; j < n; ++j)
+        if (col_exp[j] != none)
+            col_span[j] = col_exp[j] - col_min[j];
+    auto too_wide = [&](int64_t i, int64_t j) { return row_span[i] > l || col_span[j] > l - row_span[i]; };
+    if (*std::min_element(row_span.begin(), row_span.end()) + *std::min_element(col_span.begin(), col_span.end()) > l) {
+        Rgemm(transa, transb, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+        return;
+    }
+
+    const int64_t mr = 4, nr = 4, bytes = l * static_cast<int64_t>(sizeof(mp_limb_t));
+    const int64_t kc = std::min(k, std::max<int64_t>(16, defaults::l1_cache_bytes / ((mr + nr) * bytes)));
+    const int64_t mc = std::max<int64_t>(mr, defaults::l2_cache_bytes / (kc * bytes) / mr * mr);
+    const int64_t nc = mc / mr * nr;
+    const mp_size_t w = 2 * l + 1;
+    gemm_panel ap, bp;
+    std::vector<mp_limb_t> acc;
+    const bool parallel = run_parallel(m * n * k), beta_one = beta == 1, beta_zero = beta == 0;
+#if !defined _OPENMP
+    (void)parallel;
+#endif
+
+    for (int64_t jc = 0; jc < n; jc += nc) {
+        const int64_t nb = std::min(nc, n - jc), npanels_b = (nb + nr - 1) / nr;
+        acc.assign(static_cast<size_t>(m * nb * w), 0);
+        for (int64_t pc = 0; pc < k; pc += kc) {
+            const int64_t kb = std::min(kc, k - pc);
+            bp.resize(npanels_b * kb * nr, l);
+            for (int64_t q = 0; q < npanels_b; ++q)
+                for (int64_t p = 0; p < kb; ++p)
+                    for (int64_t jj = 0; jj < nr; ++jj) {
+                        const int64_t j = jc + q * nr + jj;
+                        const size_t idx = (q * kb + p) * nr + jj;
+                        if (j < jc + nb)
+                            bp.set(idx, opb(pc + p, j), col_exp[j]);
+                        else
+                            bp.set_zero(idx);
+                    }
+            for (int64_t ic = 0; ic < m; ic += mc) {
+                const int64_t mb = std::min(mc, m - ic), npanels_a = (mb + mr - 1) / mr;
+                ap.resize(npanels_a * kb * mr, l);
+                for (int64_t q = 0; q < npanels_a; ++q)
+                    for (int64_t p = 0; p < kb; ++p)
+                        for (int64_t ii = 0; ii < mr; ++ii) {
+                            const int64_t i = ic + q * mr + ii;
+                            const size_t idx = (q * kb + p) * mr + ii;
+                            if (i < ic + mb)
+                                ap.set(idx, opa(i, pc + p), row_exp[i]);
+                            else
+                                ap.set_zero(idx);
+                        }
+#if defined _OPENMP
+#pragma omp parallel if (parallel)
+#endif
+                {
+                    std::vector<mp_limb_t> product(2 * l);
+#if defined _OPENMP
+#pragma omp for schedule(static)
+#endif
+                    // the padding rows and columns of the last panels are zero, so the kernel never
+                    // touches accumulators outside m x nb
+                    for (int64_t qb = 0; qb < npanels_b; ++qb)
+                        for (int64_t qa = 0; qa < npanels_a; ++qa)
+                            gemm_micro_kernel(kb, mr, nr, ap, qa * kb * mr, bp, qb * kb * nr, &acc[(ic + qa * mr + qb * nr * m) * w], m, product.data());
+                }
+            }
+        }
+        // C(:, jc:jc + nb) := alpha * acc + beta * C(:, jc:jc + nb)
+#if defined _OPENMP
+#pragma omp parallel if (parallel)
+#endif
+        {
+            std::vector<mp_limb_t> mantissa(w);
+#if defined _OPENMP
+#pragma omp for schedule(static)
+#endif
+            for (int64_t jl = 0; jl < nb; ++jl) {
+                for (int64_t i = 0; i < m; ++i) {
+                    if (too_wide(i, jc + jl))
+                        continue;
+                    mpf_class &c = C[i + (jc + jl) * ldc];
+                    const mp_limb_t *a = &acc[(i + jl * m) * w];
+                    const bool negative = static_cast<mp_limb_signed_t>(a[w - 1]) < 0;
+                    if (negative)
+                        mpn_neg(mantissa.data(), a, w);
+                    else
+                        std::copy(a, a + w, mantissa.begin());
+                    mp_size_t size = w;
+                    while (size > 0 && mantissa[size - 1] == 0)
+                        --size;
+                    if (beta_zero)
+                        c = 0;
+                    else if (!beta_one)
+                        c *= beta;
+                    if (size == 0)
+                        continue;
+                    // read-only view of the accumulator; its top limb has weight row_exp + col_exp + 1
+                    __mpf_struct sum;
+                    sum._mp_prec = size;
+                    sum._mp_size = negative ? -size : size;
+                    sum._mp_exp = row_exp[i] + col_exp[jc + jl] + 1 - w + size;
+                    sum._mp_d = mantissa.data();
+                    mpf_ptr t = mpf_scratch(mpf_binary_prec(alpha.get_prec(), c.get_prec()));
+                    mpf_mul(t, alpha.get_mpf_t(), &sum);
+                    mpf_add(c.get_mpf_t(), c.get_mpf_t(), t);
+                }
+            }
+        }
+    }
+    // a row of op(A) that is too wide by itself goes to Rgemm as a whole, otherwise element by element
+    for (int64_t i = 0; i < m; ++i) {
+        const mpf_class *a = nota ? A + i : A + i * lda;
+        if (row_span[i] > l) {
+            Rgemm(transa, transb, 1, n, k, alpha, a, lda, B, ldb, beta, C + i, ldc);
+            continue;
+        }
+        for (int64_t j = 0; j < n; ++j)
+            if (too_wide(i, j))
+                Rgemm(transa, transb, 1, 1, k, alpha, a, lda, notb ? B + j * ldb : B + j, ldb, beta, C + i + j * ldc, ldc);
+    }
+}
+
+// count mpf_class values of precision prec (mpf_class(0, prec) is honoured in every mode)
+inline std::vector<mpf_class> strassen_workspace(int64_t count, mp_bitcnt_t prec) {
+    std::vector<mpf_class> w;
+    w.reserve(count);
+    for (int64_t i = 0; i < count; ++i)
+        w.emplace_back(0, prec);
+    return w;
+}
+// Z := X + Y or Z := X - Y on m x n matrices, rounded to the precision of Z
+inline void strassen_add(int64_t m, int64_t n, const mpf_class *X, int64_t ldx, const mpf_class *Y, int64_t ldy, mpf_class *Z, int64_t ldz, bool subtract = false) {
+    for (int64_t j = 0; j < n; ++j)
+        for (int64_t i = 0; i < m; ++i) {
+            if (subtract)
+                mpf_sub(Z[i + j * ldz].get_mpf_t(), X[i + j * ldx].get_mpf_t(), Y[i + j * ldy].get_mpf_t());
+            else
+                mpf_add(Z[i + j * ldz].get_mpf_t(), X[i + j * ldx].get_mpf_t(), Y[i + j * ldy].get_mpf_t());
+        }
+}
+
+// C := A * B (m x k times k x n) by the Winograd variant of Strassen's algorithm: 7 products and 15
+// additions of half-size blocks per level. Odd dimensions peel the last row, column or inner index
+// off and add them with Rgemm_packed. The seven products of the first task_levels levels are OpenMP
+// tasks; C and the temporaries are at precision prec. Below the tasks, all nodes of a level have the
+// same dimensions and run one after another, so they share the temporaries of that level in arena.
+inline void strassen_multiply(int64_t m, int64_t n, int64_t k, const mpf_class *A, int64_t lda, const mpf_class *B, int64_t ldb, mpf_class *C, int64_t ldc, mp_bitcnt_t prec, int task_levels, std::deque<std::vector<mpf_class>> *arena = nullptr, size_t level = 0) {
+    // the blocks are multiplied at the working precision, without the extra limb of mpf
+    const mp_size_t limbs = static_cast<mp_size_t>((prec + GMP_NUMB_BITS - 1) / GMP_NUMB_BITS);
+    const mpf_class one(1), zero(0);
+    if (std::min({m, n, k}) <= std::max<int64_t>(defaults::strassen_crossover, 1)) {
+        if (defaults::strassen_leaf_hook != nullptr)
+            defaults::strassen_leaf_hook();
+        Rgemm_packed("N", "N", m, n, k, one, A, lda, B, ldb, zero, C, ldc, limbs);
+        return;
+    }
+    const int64_t m2 = m / 2, n2 = n / 2, k2 = k / 2;
+    const mpf_class *A11 = A, *A12 = A + k2 * lda, *A21 = A + m2, *A22 = A + m2 + k2 * lda;
+    const mpf_class *B11 = B, *B12 = B + n2 * ldb, *B21 = B + k2, *B22 = B + k2 + n2 * ldb;
+    mpf_class *C11 = C, *C12 = C + n2 * ldc, *C21 = C + m2, *C22 = C + m2 + n2 * ldc;
+
+    // S1 = A21 + A22, S2 = S1 - A11, S3 = A11 - A21, S4 = A12 - S2 and
+    // T1 = B12 - B11, T2 = B22 - T1, T3 = B22 - B12, T4 = T2 - B21
+    std::deque<std::vector<mpf_class>> local;
+    if (task_levels <= 0 && arena == nullptr) {
+        arena = &local;
+        level = 0;
+    }
+    std::vector<mpf_class> own;
+    const int64_t count = 4 * (m2 * k2 + k2 * n2 + m2 * n2);
+    if (arena == nullptr)
+        own = strassen_workspace(count, prec);
+    else if (arena->size() <= level)
+        arena->push_back(strassen_workspace(count, prec));
+    mpf_class *S1 = arena == nullptr ? own.data() : (*arena)[level].data();
+    mpf_class *S2 = S1 + m2 * k2, *S3 = S2 + m2 * k2, *S4 = S3 + m2 * k2;
+    mpf_class *T1 = S4 + m2 * k2, *T2 = T1 + k2 * n2, *T3 = T2 + k2 * n2, *T4 = T3 + k2 * n2;
+    strassen_add(m2, k2, A21, lda, A22, lda, S1, m2);
+    strassen_add(m2, k2, S1, m2, A11, lda, S2, m2, true);
+    strassen_add(m2, k2, A11, lda, A21, lda, S3, m2, true);
+    strassen_add(m2, k2, A12, lda, S2, m2, S4, m2, true);
+    strassen_add(k2, n2, B12, ldb, B11, ldb, T1, k2, true);
+    strassen_add(k2, n2, B22, ldb, T1, k2, T2, k2, true);
+    strassen_add(k2, n2, B22, ldb, B12, ldb, T3, k2, true);
+    strassen_add(k2, n2, T2, k2, B21, ldb, T4, k2, true);
+
+    // P1 = A11 B11, P2 = A12 B21, P3 = S4 B22, P4 = A22 T4, P5 = S1 T1, P6 = S2 T2, P7 = S3 T3;
+    // P3, P5 and P7 go to C12, C22 and C21
+    mpf_class *P1 = T4 + k2 * n2, *P2 = P1 + m2 * n2, *P4 = P2 + m2 * n2, *P6 = P4 + m2 * n2;
+    const int next = task_levels - 1;
+#if defined _OPENMP
+#pragma omp taskgroup
+#endif
+    {
+#if defined _OPENMP
+#pragma omp task if (task_levels > 0)
+#endif
+        strassen_multiply(m2, n2, k2, A11, lda, B11, ldb, P1, m2, prec, next, arena, level + 1);
+#if defined _OPENMP
+#pragma omp task if (task_levels > 0)
+#endif
+        strassen_multiply(m2, n2, k2, A12, lda, B21, ldb, P2, m2, prec, next, arena, level + 1);
+#if defined _OPENMP
+#pragma omp task if (task_levels > 0)
+#endif
+        strassen_multiply(m2, n2, k2, S4, m2, B22, ldb, C12, ldc, prec, next, arena, level + 1);
+#if defined _OPENMP
+#pragma omp task if (task_levels > 0)
+#endif
+        strassen_multiply(m2, n2, k2, A22, lda, T4, k2, P4, m2, prec, next, arena, level + 1);
+#if defined _OPENMP
+#pragma omp task if (task_levels > 0)
+#endif
+        strassen_multiply(m2, n2, k2, S1, m2, T1, k2, C22, ldc, prec, next, arena, level + 1);
+#if defined _OPENMP
+#pragma omp task if (task_levels > 0)
+#endif
+        strassen_multiply(m2, n2, k2, S2, m2, T2, k2, P6, m2, prec, next, arena, level + 1);
+        strassen_multiply(m2, n2, k2, S3, m2, T3, k2, C21, ldc, prec, next, arena, level + 1);
+    }
+
+    // U2 = P1 + P6, U3 = U2 + P7, U4 = U2 + P5 and
+    // C11 = P1 + P2, C12 = U4 + P3, C21 = U3 - P4, C22 = U3 + P5
+    strassen_add(m2, n2, P1, m2, P6, m2, P6, m2);
+    strassen_add(m2, n2, C21, ldc, P6, m2, C21, ldc);
+    strassen_add(m2, n2, C12, ldc, P6, m2, C12, ldc);
+    strassen_add(m2, n2, C12, ldc, C22, ldc, C12, ldc);
+    strassen_add(m2, n2, C21, ldc, C22, ldc, C22, ldc);
+    strassen_add(m2, n2, C21, ldc, P4, m2, C21, ldc, true);
+    strassen_add(m2, n2, P1, m2, P2, m2, C11, ldc);
+
+    // the peeled inner index, last column and last row
+    if (k % 2 != 0)
+        for (int64_t j = 0; j < 2 * n2; ++j)
+            for (int64_t i = 0; i < 2 * m2; ++i)
+                addmul(C[i + j * ldc], A[i + (k - 1) * lda], B[k - 1 + j * ldb]);
+    if (n % 2 != 0)
+        Rgemm_packed("N", "N", m, 1, k, one, A, lda, B + (n - 1) * ldb, ldb, zero, C + (n - 1) * ldc, ldc, limbs);
+    if (m % 2 != 0)
+        Rgemm_packed("N", "N", 1, 2 * n2, k, one, A + m - 1, lda, B, ldb, zero, C + m - 1, ldc, limbs);
+}
+
+// Rgemm by Strassen-Winograd recursion down to defaults::strassen_crossover, for precisions where a
+// multiplication costs many additions. op(A) and op(B) are copied and op(A) * op(B) is formed with
+// defaults::strassen_guard_bits more bits than the largest precision in C, which absorbs the error
+// growth of the recursion, and rounded into C once. With OpenMP, the products of the top two levels
+// are tasks.
+inline void Rgemm_strassen(const char *transa, const char *transb, int64_t m, int64_t n, int64_t k, const mpf_class &alpha, const mpf_class *A, int64_t lda, const mpf_class *B, int64_t ldb, const mpf_class &beta, mpf_class *C, int64_t ldc) {
+    gemm_check("Rgemm_strassen", transa, transb, m, n, k, lda, ldb, ldc);
+    if (m == 0 || n == 0 || ((alpha == 0 || k == 0) && beta == 1))
+        return;
+    if (alpha == 0 || std::min({m, n, k}) <= std::max<int64_t>(defaults::strassen_crossover, 1)) {
+        Rgemm_packed(transa, transb, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+        return;
+    }
+    const bool nota = lsame(transa, 'N'), notb = lsame(transb, 'N');
+    // the error of the recursion is relative to max |op(A)| max |op(B)|; when the exponents of op(A)
+    // and op(B) span more than the guard bits, it would swamp the smallest products, so such
+    // operands are left to Rgemm_packed, which keeps every element to the precision of Rgemm
+    auto exponent_span = [](int64_t rows, int64_t cols, const mpf_class *X, int64_t ldx) {
+        long lo = std::numeric_limits<long>::max(), hi = std::numeric_limits<long>::min();
+        for (int64_t j = 0; j < cols; ++j)
+            for (int64_t i = 0; i < rows; ++i) {
+                mpf_srcptr f = X[i + j * ldx].get_mpf_t();
+                if (mpf_sgn(f) == 0)
+                    continue;
+                long e;
+                mpf_get_d_2exp(&e, f);
+                lo = std::min(lo, e);
+                hi = std::max(hi, e);
+            }
+        return lo > hi ? mp_bitcnt_t(0) : static_cast<mp_bitcnt_t>(hi - lo);
+    };
+    const mp_bitcnt_t span = exponent_span(nota ? m : k, nota ? k : m, A, lda) + exponent_span(notb ? k : n, notb ? n : k, B, ldb);
+    if (span > defaults::strassen_guard_bits) {
+        Rgemm_packed(transa, transb, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+        return;
+    }
+    mp_bitcnt_t prec = 0;
+    for (int64_t j = 0; j < n; ++j)
+        for (int64_t i = 0; i < m; ++i)
+            prec = std::max(prec, C[i + j * ldc].get_prec());
+    prec += defaults::strassen_guard_bits;
+
+    std::vector<mpf_class> a = strassen_workspace(m * k, prec), b = strassen_workspace(k * n, prec), product = strassen_workspace(m * n, prec);
+    for (int64_t l = 0; l < k; ++l)
+        for (int64_t i = 0; i < m; ++i)
+            mpf_set(a[i + l * m].get_mpf_t(), (nota ? A[i + l * lda] : A[l + i * lda]).get_mpf_t());
+    for (int64_t j = 0; j < n; ++j)
+        for (int64_t l = 0; l < k; ++l)
+            mpf_set(b[l + j * k].get_mpf_t(), (notb ? B[l + j * ldb] : B[j + l * ldb]).get_mpf_t());
+
+    // decided outside the region: inside it, run_parallel sees omp_in_parallel() and says no
+    const bool parallel = run_parallel(m * n * k);
+#if defined _OPENMP
+#pragma omp parallel if (parallel)
+#pragma omp single
+#endif
+    strassen_multiply(m, n, k, a.data(), m, b.data(), k, product.data(), m, prec, parallel ? 2 : 0);
+
+    const bool beta_one = beta == 1, beta_zero = beta == 0;
+#if defined _OPENMP
+#pragma omp parallel for schedule(static) if (run_parallel(m * n))
+#endif
+    for (int64_t j = 0; j < n; ++j)
+        for (int64_t i = 0; i < m; ++i) {
+            mpf_class &c = C[i + j * ldc];
+            if (beta_zero)
+                c = 0;
+            else if (!beta_one)
+                c *= beta;
+            addmul(c, alpha, product[i + j * m]);
+        }
+}
+
+} // namespace blas
+#if !defined ___GMPXX_DONT_USE_NAMESPACE___
+} // namespace gmpxx
+#endif
+
+#endif // ___GMPXX_MKII_BLAS_H___
@@ -33,11 +33,13 @@
 #include <iomanip>
 #include <cmath>
 #include <vector>
+#include <numeric>
 
 #if defined USE_ORIGINAL_GMPXX
 #include <gmpxx.h>
 #else
 #include "gmpxx_mkII.h"
+#include "gmpxx_mkII_blas.h"
 #if !defined ___GMPXX_STRICT_COMPATIBILITY___
 using namespace gmpxx;
 #endif
@@ -241,6 +243,816 @@ void testAssignmentOperator_the_rule_of_five() {
     std::cout << "##testing the rule 5 of 5: copy assignment test passed.\n" << std::endl;
     std::cout << "testAssignmentOperator_the_rule_of_five passed" << std::endl;
 }
+#if !defined USE_ORIGINAL_GMPXX
+static size_t gmp_allocation_count = 0;
+static void *(*saved_alloc)(size_t);
+static void *counting_alloc(size_t size) {
+    gmp_allocation_count++;
+    return saved_alloc(size);
+}
+#endif
+void test_mpf_class_moved_from() {
+#if !defined USE_ORIGINAL_GMPXX
+    mpf_class a("123.0", 1024);
+    void *(*saved_realloc)(void *, size_t, size_t);
+    void (*saved_free)(void *, size_t);
+    mp_get_memory_functions(&saved_alloc, &saved_realloc, &saved_free);
+    mp_set_memory_functions(counting_alloc, saved_realloc, saved_free);
+    mpf_class b(std::move(a));
+    mpf_class c(std::move(b));
+    mp_set_memory_functions(saved_alloc, saved_realloc, saved_free);
+    assert(gmp_allocation_count == 0 && "move construction allocated");
+    assert(c == 123 && c.get_prec() == 1024);
+    // moved-from objects read as zero, keep their precision and can be reused
+    assert(a == 0 && b == 0 && sgn(a) == 0 && a.get_prec() == 1024);
+    mpf_class d(b);
+    assert(d == 0 && d.get_prec() == 1024);
+    a += 2;
+    b = c;
+    assert(a == 2 && a.get_prec() == 1024 && b == 123);
+    mpf_class e(std::move(c));
+    c = 1.5;
+    assert(c == 1.5 && c.get_prec() == 1024);
+    mpf_class f(std::move(e));
+    mpf_add_ui(e.get_mpf_t(), e.get_mpf_t(), 7);
+    assert(e == 7);
+    mpf_class g(std::move(f));
+    f.swap(g);
+    assert(f == 123 && g == 0);
+    g = std::move(f);
+    assert(g == 123);
+    std::vector<mpf_class> v;
+    for (int i = 0; i < 100; i++)
+        v.push_back(mpf_class(i));
+    assert(v[99] == 99);
+    std::cout << "test_mpf_class_moved_from passed." << std::endl;
+#endif
+}
+void test_rvalue_operators() {
+#if !defined USE_ORIGINAL_GMPXX
+    mpf_class a(1.5), b(2.25), c(-4), d(0.5);
+    mpf_class *p = &a;
+    void *(*saved_realloc)(void *, size_t, size_t);
+    void (*saved_free)(void *, size_t);
+    mp_get_memory_functions(&saved_alloc, &saved_realloc, &saved_free);
+    gmp_allocation_count = 0;
+    mp_set_memory_functions(counting_alloc, saved_realloc, saved_free);
+    mpf_class e = a + b + c + d;
+    mpf_class f = (a * b - c) / d + *p;
+    mp_set_memory_functions(saved_alloc, saved_realloc, saved_free);
+    assert(gmp_allocation_count == 2 && "rvalue operators allocated more than once per expression");
+    assert(e == 0.25 && f == 16.25);
+    assert(a - (b + c) == 3.25 && a * (b * d) == 1.6875);
+    assert((a + b) * (c + d) == -13.125 && -(a + b) == -3.75 && (a + b) - (c + d) == 7.25);
+#if !defined ___GMPXX_MKII_NOPRECCHANGE___
+    // a temporary of lower precision is not reused
+    mpf_class lo(1.0, 64), hi(3.0, 1024);
+    hi /= 7;
+    mpf_class g = (lo + lo) * hi;
+    assert(g.get_prec() == 1024);
+    mpf_class h(2.0, 1024);
+    h *= hi;
+    assert(g == h);
+#endif
+    mpz_class za(7), zb(-3), zc(100);
+    assert(za + zb + zc == 104 && (za * zb) - zc == -121 && zc - (za * zb) == 121 && (zc + za) / (za + zb) == 26 && zc / (za + zb) == 25 && -(za + zb) == -4);
+    mpq_class qa(1, 3), qb(3, 4), qc(-2, 5);
+    assert(qa + qb + qc == mpq_class(41, 60) && (qa * qb) - qc == mpq_class(13, 20) && qc / (qa - qb) == mpq_class(24, 25) && -(qa * qb) == mpq_class(-1, 4));
+    std::cout << "test_rvalue_operators passed." << std::endl;
+#endif
+}
+void test_expression_templates() {
+#if defined ___GMPXX_MKII_EXPRESSION_TEMPLATES___
+    mpf_class a(1.5), b(2.0), c(3.0), d(-0.5), e(4.0);
+    static_assert(std::is_same<decltype(b * c), mpf_mul_expr>::value, "b * c must be an expression");
+    a += b * c; // warm up the scratch value
+    void *(*saved_realloc)(void *, size_t, size_t);
+    void (*saved_free)(void *, size_t);
+    mp_get_memory_functions(&saved_alloc, &saved_realloc, &saved_free);
+    gmp_allocation_count = 0;
+    mp_set_memory_functions(counting_alloc, saved_realloc, saved_free);
+    a += b * c;
+    assert(a == 13.5);
+    a -= d * e;
+    assert(a == 15.5);
+    a = b * c + d * e;
+    assert(a == 4);
+    a = b * c + e;
+    assert(a == 10);
+    a = e + b * c;
+    assert(a == 10);
+    // the destination may appear on the right-hand side
+    a = a * b + c * a;
+    assert(a == 50);
+    e = d * b + e;
+    assert(e == 3);
+    mp_set_memory_functions(saved_alloc, saved_realloc, saved_free);
+    assert(gmp_allocation_count == 0 && "fused evaluation allocated");
+    // any other use evaluates the expression
+    mpf_class f = b * c;
+    assert(f == 6 && b * c == 6 && 6 == b * c && b * c > d * e && b * c + 1 == 7 && 1 - b * c == -5);
+    assert((b * c) * d == -3 && (b * c) / (d + d) == -6 && -(b * c) == -6 && abs(d * c) == 1.5 && sqrt(b * b) == 2);
+    assert(b * c + d * e + b * b == 8.5 && (b + c) * (b * c) == 30);
+    std::stringstream ss;
+    ss << b * c;
+    assert(ss.str() == "6");
+#if !defined ___GMPXX_MKII_NOPRECCHANGE___
+    mpf_class lo(3.0, 64), hi(1.0, 1024);
+    hi /= 3;
+    mpf_class product(0.0, 1024);
+    mpf_mul(product.get_mpf_t(), lo.get_mpf_t(), hi.get_mpf_t());
+    assert(mpf_class(lo * hi).get_prec() == 1024 && lo * hi == product && abs(lo * hi - 1) < 1e-300);
+#endif
+    std::cout << "test_expression_templates passed." << std::endl;
+#endif
+}
+void test_fused_multiply_add() {
+#if !defined USE_ORIGINAL_GMPXX
+    mpz_class z(10), x("123456789012345678901234567890"), y(-7);
+    addmul(z, x, y);
+    assert(z == 10 + x * y);
+    submul(z, x, y);
+    assert(z == 10);
+    addmul_ui(z, x, 3);
+    submul_ui(z, x, 3);
+    addmul(z, x, -2);
+    submul(z, x, 5u);
+    assert(z == 10 - 7 * x);
+    z = 0;
+    addmul(z, mpz_class(1), LONG_MIN);
+    assert(z == LONG_MIN);
+    addmul(z, z, z); // acc may alias the factors
+    assert(z == mpz_class(LONG_MIN) + mpz_class(LONG_MIN) * LONG_MIN);
+    assert(fma(x, y, z) == x * y + z && fms(x, y, z) == x * y - z);
+
+    mpq_class q(1, 2), r(2, 3), s(-3, 4);
+    addmul(q, r, s);
+    assert(q == 0);
+    submul(q, r, s);
+    assert(q == mpq_class(1, 2));
+    assert(fma(q, r, s) == mpq_class(-5, 12) && fms(q, r, s) == mpq_class(13, 12));
+
+    mpf_class a(1.5), b(2.0), c(-0.25);
+    addmul(a, b, c);
+    assert(a == 1);
+    submul(a, b, c);
+    assert(a == 1.5);
+    addmul(a, b, 3);
+    addmul(a, b, -1);
+    submul_ui(a, b, 2);
+    addmul_ui(a, b, 1);
+    addmul(a, b, 0.5);
+    submul(a, b, -0.25);
+    assert(a == 5);
+    addmul(a, a, a);
+    assert(a == 30);
+    assert(fma(b, c, a) == 29.5 && fms(b, c, a) == -30.5);
+    void *(*saved_realloc)(void *, size_t, size_t);
+    void (*saved_free)(void *, size_t);
+    mp_get_memory_functions(&saved_alloc, &saved_realloc, &saved_free);
+    gmp_allocation_count = 0;
+    mp_set_memory_functions(counting_alloc, saved_realloc, saved_free);
+    for (int i = 0; i < 8; i++) {
+        addmul(a, b, c);
+        submul(a, b, 2.0);
+        addmul(q, r, s);
+    }
+    mp_set_memory_functions(saved_alloc, saved_realloc, saved_free);
+    assert(a == 30 - 8 * 4.5 && q == mpq_class(1, 2) - 8 * mpq_class(1, 2));
+    assert(gmp_allocation_count == 0 && "fused multiply-add allocated");
+    std::cout << "test_fused_multiply_add passed." << std::endl;
+#endif
+}
+void test_pool_allocator() {
+#if !defined USE_ORIGINAL_GMPXX
+    bool was_installed = pool_allocator::is_installed();
+    install_pool_allocator();
+    assert(pool_allocator::is_installed());
+    pool_allocator_statistics before = pool_stats;
+    mpf_class sum(0);
+    for (int i = 0; i < 100; i++) {
+        mpf_class a(i);
+        sum += a * 0.5;
+    }
+    assert(sum == 2475);
+    assert(pool_stats.hits - before.hits >= 2 * 99 && pool_stats.misses - before.misses <= 3);
+    {
+        mpf_class large(1, 64 * pool_allocator::max_limbs); // too large to be pooled
+    }
+    assert(pool_stats.bypasses > before.bypasses);
+    mpz_class z(1);
+    for (int i = 0; i < 100; i++)
+        z = z * 12345 + 1;
+    assert(z > 0 && z % 12345 == 1);
+    if (!was_installed) {
+        uninstall_pool_allocator();
+        assert(!pool_allocator::is_installed());
+        sum = sqrt(sum); // blocks from the pool go back to the previous allocator
+    }
+    std::cout << "test_pool_allocator passed." << std::endl;
+#endif
+}
+void test_scratch_scope() {
+#if !defined USE_ORIGINAL_GMPXX
+    {
+        scratch_scope outer;
+        mpf_ptr a = outer.get(256, 3UL);
+        size_t reserved = scratch_scope::reserved_limbs();
+        {
+            scratch_scope inner;
+            mpf_ptr b = inner.get(256, a);
+            mpf_mul(b, b, a);
+            assert(mpf_cmp_ui(b, 9) == 0);
+        }
+        mpf_ptr c = outer.get(256); // reuses the limbs released by inner
+        mpf_sqrt(c, a);
+        mpf_mul(c, c, c);
+        mpf_sub_ui(c, c, 3);
+        mpf_abs(c, c);
+        assert(mpf_cmp_d(c, 1e-70) < 0);
+        assert(scratch_scope::reserved_limbs() == reserved);
+    }
+    mpf_class x(0.5, 512), one(1, 512), epsilon(1, 512);
+    epsilon.div_2exp(500);
+    mpf_class s = sin(x), c = cos(x);
+    (void)log(x);
+    (void)atan(x);
+    size_t reserved = scratch_scope::reserved_limbs();
+    assert(reserved > 0);
+    for (int i = 0; i < 16; i++) {
+        s = sin(x);
+        c = cos(x);
+        assert(abs(s * s + c * c - one) < epsilon);
+        assert(abs(exp(log(x)) - x) < epsilon);
+        assert(abs(tan(atan(x)) - x) < epsilon);
+    }
+    assert(scratch_scope::reserved_limbs() == reserved);
+    std::cout << "test_scratch_scope passed." << std::endl;
+#endif
+}
+void test_mpf_vector_matrix() {
+#if !defined USE_ORIGINAL_GMPXX
+    void *(*saved_realloc)(void *, size_t, size_t);
+    void (*saved_free)(void *, size_t);
+    mp_get_memory_functions(&saved_alloc, &saved_realloc, &saved_free);
+    gmp_allocation_count = 0;
+    mp_set_memory_functions(counting_alloc, saved_realloc, saved_free);
+    mpf_vector x(100), y(100);
+    mpf_matrix A(10, 20, 16, mpf_get_default_prec());
+    for (size_t i = 0; i < x.size(); i++) {
+        x[i] = i;
+        y[i] = 0.5;
+        y[i] *= x[i];
+    }
+    for (size_t j = 0; j < A.cols(); j++)
+        for (size_t i = 0; i < A.rows(); i++)
+            A(i, j) = x[i + j];
+    mp_set_memory_functions(saved_alloc, saved_realloc, saved_free);
+    assert(gmp_allocation_count == 0 && "the slab allocated per element");
+
+    assert(x.get_prec() == mpf_get_default_prec() && x[3].get_prec() == x.get_prec());
+    assert(x[3] == 3 && y[3] == 1.5 && x[1] < y[4] && 2 < y[5] && y[5] != x[5]);
+    assert(A(2, 3) == 5 && A.data() + 2 + 3 * A.ld() == A(2, 3).get_mpf_t());
+    mpf_class s = 0;
+    for (size_t i = 0; i < x.size(); i++)
+        s += x[i] * y[i];
+    assert(s == 328350 / 2);
+    mpf_class u = 0;
+    for (size_t i = 0; i < x.size(); i++) {
+        addmul(u, x[i], y[i]);
+        submul(A(0, 0), x[i], s);
+    }
+    assert(u == s && A(0, 0) == -s * 4950);
+    mpf_class t = x[2] + mpf_class(1) - y[2] / x[1];
+    assert(t == 2 && -x[2] == -2 && sqrt(x[4]) == 2 && abs(-x[3]) == 3);
+    x[1] += x[2];
+    x[1] -= 1;
+    x[1] *= 4;
+    x[1] /= mpf_class(2);
+    assert(x[1] == 4);
+    x[0] = mpz_class(7);
+    x[0] += 1;
+    assert(x[0] == 8);
+    mpf_add(x.data() + 0, x.data() + 1, x.data() + 2); // the elements are ordinary mpf_t
+    assert(x[0] == 6);
+    swap(x[0], x[1]);
+    assert(x[0] == 4 && x[1] == 6);
+    {
+        // across containers each element keeps its own limbs, so v can go first
+        mpf_vector *v = new mpf_vector(2, x.get_prec());
+        (*v)[0] = 9;
+        mpf_vector other(2, x.get_prec());
+        other[0] = 11;
+        swap((*v)[0], other[0]);
+        assert((*v)[0] == 11 && other[0] == 9);
+        delete v;
+        assert(other[0] == 9 && other[0] + 1 == 10);
+        mpf_class f(5, x.get_prec());
+        swap(other[1], f);
+        swap(f, other[0]);
+        assert(other[1] == 5 && other[0] == 0 && f == 9);
+    }
+
+    const mpf_vector z(x);
+    x[0] = 0;
+    assert(z[0] == 4 && z.size() == x.size() && z.data() != x.data());
+    mpf_vector w(std::move(x));
+    assert(w[1] == 6 && x.size() == 0);
+    // move assignment leaves the source empty, it does not hand it the target's old elements
+    mpf_vector target(5, w.get_prec());
+    target = std::move(w);
+    assert(target.size() == 100 && target[1] == 6 && w.size() == 0 && w.data() == nullptr);
+    mpf_matrix B(3, 3), C(std::move(B));
+    assert(C.rows() == 3 && B.rows() == 0 && B.cols() == 0 && B.ld() == 0 && B.data() == nullptr);
+    B = std::move(C);
+    assert(B.rows() == 3 && B.cols() == 3 && C.rows() == 0 && C.cols() == 0 && C.data() == nullptr);
+    std::cout << "test_mpf_vector_matrix passed." << std::endl;
+#endif
+}
+void test_move_assign_policy() {
+#if !defined USE_ORIGINAL_GMPXX && !defined ___GMPXX_MKII_NOPRECCHANGE___
+    prec_policy saved = gmpxx_defaults::move_policy;
+#if defined ___GMPXX_MKII_MOVE_STATS___
+    move_assign_statistics before = move_stats;
+#endif
+    mpf_class a(1, 512), b(0, 512);
+    a = mpf_class(2, 512);
+    assert(a == 2 && a.get_prec() == 512);
+    gmpxx_defaults::move_policy = prec_policy::keep_destination;
+    a = mpf_class(3, 576);
+    assert(a == 3 && a.get_prec() == 512);
+    gmpxx_defaults::move_policy = prec_policy::adopt_source;
+    a = mpf_class(4, 576);
+    assert(a == 4 && a.get_prec() == 576);
+#if defined ___GMPXX_MKII_MOVE_STATS___
+    assert(move_stats.swaps == before.swaps + 2 && move_stats.copies == before.copies + 1);
+#endif
+    b = std::move(a);
+    assert(b == 4 && b.get_prec() == 576);
+    a = 5; // a holds the 512-bit limbs of b
+    assert(a == 5 && a.get_prec() == 512);
+    gmpxx_defaults::move_policy = saved;
+    std::cout << "test_move_assign_policy passed." << std::endl;
+#endif
+}
+void test_mpz_small() {
+#if !defined USE_ORIGINAL_GMPXX
+    const long lmax = std::numeric_limits<long>::max(), lmin = std::numeric_limits<long>::min();
+    mpz_class a(lmax), b(lmin), c;
+    c = a + 1; // promotes to the mpz_t
+    assert(c.get_str() == "9223372036854775808" && !c.fits_slong_p());
+    c -= 1;
+    assert(c == a && c.get_si() == lmax);
+    c = -b;
+    assert(c.get_str() == "9223372036854775808");
+    c = b - 1;
+    assert(c < b && c.get_str() == "-9223372036854775809");
+    c = a * 3;
+    assert(c == mpz_class("27670116110564327421"));
+    c = 7 - b;
+    assert(c > a && c.get_str() == "9223372036854775815");
+    c = std::numeric_limits<unsigned long>::max();
+    assert(c.get_ui() == std::numeric_limits<unsigned long>::max() && c > a && c > 0UL);
+    mpz_class d(-12), e(5);
+    assert(d * e == -60 && d + e == -7 && e - d == 17 && -d == 12 && d.get_ui() == 12UL && sgn(d) == -1);
+    assert(d < e && e > d && d != e && d < 0 && 0 > d && d < 3U && e == 5U && e >= 5 && cmp(d, e) < 0);
+    ++e;
+    --d;
+    assert(e == 6 && d == -13);
+    // get_mpz_t() sees the small value, and writes through it are seen by the class
+    mpz_add_ui(d.get_mpz_t(), d.get_mpz_t(), 20);
+    assert(d == 7 && mpz_cmp_si(d.get_mpz_t(), 7) == 0);
+    d += e;
+    assert(mpz_cmp_si(d.get_mpz_t(), 13) == 0);
+    // copies, moves and swaps between a small and a large value
+    mpz_class f(c), g(std::move(d)), h("123456789012345678901234567890");
+    assert(f == c && g == 13);
+    swap(g, h);
+    assert(h == 13 && g == mpz_class("123456789012345678901234567890"));
+    g = std::move(h);
+    assert(g == 13);
+    h = 2;
+    assert(h + g == 15);
+    // const reads go through the read-only view, also at the ends of the range
+    const mpz_class k(-42), kmin(lmin);
+    assert(mpz_cmp_si(k.get_mpz_t(), -42) == 0 && kmin.get_str() == "-9223372036854775808" && gcd(k, mpz_class(30)) == 6);
+    int failures = 0;
+#if defined _OPENMP
+#pragma omp parallel for reduction(+ : failures)
+#endif
+    for (int i = 1; i <= 64; ++i) {
+        if (gcd(k, mpz_class(i)) != mpz_class(std::gcd(42, i)) || k.get_str() != "-42" || k / i != -42 / i)
+            ++failures;
+    }
+    assert(failures == 0);
+    std::cout << "test_mpz_small passed." << std::endl;
+#endif
+}
+void test_blas() {
+#if !defined USE_ORIGINAL_GMPXX
+    // small integers, so every result is exact and the kernels can be compared with ==
+    const int64_t m = 5, n = 4, k = 3, ld = 7;
+    std::vector<mpf_class> A(ld * 7), B(ld * 7), C(ld * 7), x(16), y(16), ref(ld * 7);
+    for (size_t i = 0; i < A.size(); i++) {
+        A[i] = static_cast<long>(i % 11) - 5;
+        B[i] = static_cast<long>(i % 7) - 3;
+        C[i] = static_cast<long>(i % 5) - 2;
+    }
+    for (int64_t i = 0; i < 16; i++) {
+        x[i] = i - 7;
+        y[i] = 3 - i;
+    }
+    mpf_class alpha(3), beta(-2);
+    int64_t saved_threshold = blas::defaults::parallel_threshold;
+    for (int64_t threshold : {std::numeric_limits<int64_t>::max(), int64_t(1)}) {
+        blas::defaults::parallel_threshold = threshold;
+        // Rdot and Raxpy with positive and negative increments
+        mpf_class dot = 0;
+        for (int64_t i = 0; i < 5; i++)
+            dot += x[2 * i] * y[12 - 3 * i];
+        assert(blas::Rdot(5, x.data(), 2, y.data(), -3) == dot);
+        assert(blas::Rdot(0, x.data(), 1, y.data(), 1) == 0);
+        std::vector<mpf_class> z(y);
+        blas::Raxpy(5, alpha, x.data(), -2, z.data(), 3);
+        for (int64_t i = 0; i < 5; i++)
+            assert(z[3 * i] == y[3 * i] + alpha * x[8 - 2 * i]);
+        // Rgemv, A is m x n with leading dimension ld
+        for (const char *trans : {"N", "t", "C"}) {
+            bool notrans = trans[0] == 'N';
+            int64_t lenx = notrans ? n : m, leny = notrans ? m : n;
+            z = y;
+            blas::Rgemv(trans, m, n, alpha, A.data(), ld, x.data(), -1, beta, z.data(), 2);
+            for (int64_t i = 0; i < leny; i++) {
+                mpf_class sum = 0;
+                for (int64_t j = 0; j < lenx; j++)
+                    sum += (notrans ? A[i + j * ld] : A[j + i * ld]) * x[lenx - 1 - j];
+                assert(z[2 * i] == alpha * sum + beta * y[2 * i]);
+            }
+        }
+        // Rgemm for all transposes, with beta = 0 ignoring the contents of C
+        for (const char *ta : {"N", "T"})
+            for (const char *tb : {"N", "C"})
+                for (const mpf_class &b : {beta, mpf_class(0), mpf_class(1)}) {
+                    bool nota = ta[0] == 'N', notb = tb[0] == 'N';
+                    std::vector<mpf_class> D(C);
+                    if (b == 0)
+                        for (int64_t j = 0; j < n; j++)
+                            D[j * ld] = 12345;
+                    blas::Rgemm(ta, tb, m, n, k, alpha, A.data(), ld, B.data(), ld, b, D.data(), ld);
+                    for (int64_t j = 0; j < n; j++)
+                        for (int64_t i = 0; i < m; i++) {
+                            mpf_class sum = 0;
+                            for (int64_t l = 0; l < k; l++)
+                                sum += (nota ? A[i + l * ld] : A[l + i * ld]) * (notb ? B[l + j * ld] : B[j + l * ld]);
+                            assert(D[i + j * ld] == alpha * sum + b * C[i + j * ld]);
+                        }
+                    for (int64_t j = 0; j < n; j++)
+                        for (int64_t i = m; i < ld; i++)
+                            assert(D[i + j * ld] == C[i + j * ld]);
+                }
+    }
+    blas::defaults::parallel_threshold = saved_threshold;
+    bool thrown = false;
+    try {
+        blas::Rgemm("X", "N", m, n, k, alpha, A.data(), ld, B.data(), ld, beta, C.data(), ld);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try {
+        blas::Rgemv("N", m, n, alpha, A.data(), m - 1, x.data(), 1, beta, y.data(), 1);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "test_blas passed." << std::endl;
+#endif
+}
+void test_mpf_exact_accumulator() {
+#if !defined USE_ORIGINAL_GMPXX
+    mpf_class big(1, 512), tiny(1, 512), one(1, 512);
+    big.mul_2exp(1000);
+    tiny.div_2exp(1000);
+    mpf_exact_accumulator acc;
+    acc.add(big).add(one).sub(big).add(tiny);
+    mpf_class sum(big + one - big + tiny);
+    assert(sum == tiny); // mpf_add loses the one
+    mpf_class expected(1, 2048);
+    expected += tiny;
+    assert(acc.get(512) == 1 && acc.get(2048) == expected);
+    acc.clear();
+    assert(acc.get() == 0);
+    acc.submul(big, big).addmul(big, big);
+    assert(acc.get() == 0);
+
+    // random terms of mixed sign and magnitude against an exact mpq_class sum
+    gmp_randclass r(gmp_randinit_default);
+    r.seed(7);
+    const int n = 200;
+    std::vector<mpf_class> x(n), y(n);
+    mpq_class exact = 0, term;
+    for (int i = 0; i < n; i++) {
+        x[i] = r.get_f(512);
+        y[i] = r.get_f(512);
+        x[i].mul_2exp(i % 13 * 50);
+        y[i].div_2exp(i % 7 * 90);
+        if (i % 3 == 0)
+            x[i] = -x[i];
+        mpq_class qx, qy;
+        mpq_set_f(qx.get_mpq_t(), x[i].get_mpf_t());
+        mpq_set_f(qy.get_mpq_t(), y[i].get_mpf_t());
+        exact += qx * qy;
+    }
+    mpf_exact_accumulator whole, first, second;
+    for (int i = 0; i < n; i++) {
+        whole.addmul(x[i], y[i]);
+        (i < n / 3 ? first : second).addmul(x[i], y[i]);
+    }
+    mpq_class got;
+    mpq_set_f(got.get_mpq_t(), whole.get(8192).get_mpf_t());
+    assert(got == exact);
+    first += second;
+    assert(first.get(8192) == whole.get(8192) && first.get(512) == whole.get(512));
+    mpf_class reference = blas::Rdot_exact(n, x.data(), 1, y.data(), 1, 512);
+    assert(reference == whole.get(512));
+    int64_t saved_threshold = blas::defaults::parallel_threshold;
+    blas::defaults::parallel_threshold = 1;
+    assert(blas::Rdot_exact(n, x.data(), 1, y.data(), 1, 512) == reference);
+    blas::defaults::parallel_threshold = saved_threshold;
+    std::cout << "test_mpf_exact_accumulator passed." << std::endl;
+#endif
+}
+void test_blas_packed() {
+#if !defined USE_ORIGINAL_GMPXX
+    const int64_t saved_l1 = blas::defaults::l1_cache_bytes, saved_l2 = blas::defaults::l2_cache_bytes;
+    const int64_t saved_threshold = blas::defaults::parallel_threshold;
+    // small cache sizes, so the blocks are partial and several kc, mc and nc blocks are used
+    blas::defaults::l1_cache_bytes = 1024;
+    blas::defaults::l2_cache_bytes = 4096;
+    const int64_t m = 23, n = 19, k = 37, ld = 41;
+    std::vector<mpf_class> A(ld * ld), B(ld * ld), C(ld * ld);
+    for (size_t i = 0; i < A.size(); i++) {
+        A[i] = static_cast<long>(i % 11) - 5;
+        B[i] = static_cast<long>(i % 7) - 3;
+        C[i] = static_cast<long>(i % 5) - 2;
+    }
+    B[3] = mpf_class(1) / 1024; // exponents below the column maximum
+    A[5 * ld] = 0;
+    mpf_class alpha(3), beta(-2);
+    for (int64_t threshold : {std::numeric_limits<int64_t>::max(), int64_t(1)}) {
+        blas::defaults::parallel_threshold = threshold;
+        for (const char *ta : {"N", "T"})
+            for (const char *tb : {"N", "C"})
+                for (const mpf_class &b : {beta, mpf_class(0), mpf_class(1)}) {
+                    std::vector<mpf_class> D(C), E(C);
+                    blas::Rgemm(ta, tb, m, n, k, alpha, A.data(), ld, B.data(), ld, b, D.data(), ld);
+                    blas::Rgemm_packed(ta, tb, m, n, k, alpha, A.data(), ld, B.data(), ld, b, E.data(), ld);
+                    assert(D == E);
+                }
+    }
+    std::vector<mpf_class> D(C);
+    blas::Rgemm_packed("N", "N", m, n, 0, alpha, A.data(), ld, B.data(), ld, beta, D.data(), ld);
+    assert(D[0] == beta * C[0] && D[m] == C[m]);
+    // one limb elements whose exponents lie far apart are kept to the precision of C
+    mpf_class big(1, 512), one(1, 512), product(0, 512);
+    big.mul_2exp(200);
+    const mpf_class a_row[2] = {big, one}, b_col[2] = {one, one};
+    blas::Rgemm_packed("N", "N", 1, 1, 2, one, a_row, 1, b_col, 2, mpf_class(0), &product, 1);
+    assert(product == big + 1);
+    // the row spans more exponents than the accumulator window; the 2^2000 product is zero and
+    // the result is the product 1 * 1 far below it
+    mpf_class huge(1, 512);
+    huge.mul_2exp(2000);
+    const mpf_class a_wide[2] = {huge, one}, b_wide[2] = {mpf_class(0, 512), one};
+    blas::Rgemm_packed("N", "N", 1, 1, 2, one, a_wide, 1, b_wide, 2, mpf_class(0), &product, 1);
+    assert(product == 1);
+    {
+        // wide rows, wide columns and narrow elements mixed in one call
+        std::vector<mpf_class> W(ld * ld), V(ld * ld);
+        for (size_t i = 0; i < W.size(); i++) {
+            W[i] = static_cast<long>(i % 13) - 6;
+            V[i] = static_cast<long>(i % 5) - 2;
+        }
+        W[2] = huge;          // row 2 of W, column 2 of W^T
+        V[ld * 3 + 1] = huge; // column 3 of V, row 3 of V^T
+        V[ld * 3 + 4] = 0;
+        for (const char *ta : {"N", "T"})
+            for (const char *tb : {"N", "T"}) {
+                std::vector<mpf_class> D(C), E(C);
+                blas::Rgemm(ta, tb, m, n, k, alpha, W.data(), ld, V.data(), ld, beta, D.data(), ld);
+                blas::Rgemm_packed(ta, tb, m, n, k, alpha, W.data(), ld, V.data(), ld, beta, E.data(), ld);
+                assert(D == E);
+            }
+    }
+
+    // random 512 bit operands of different magnitudes against Rgemm
+    gmp_randclass r(gmp_randinit_default);
+    r.seed(11);
+    for (size_t i = 0; i < A.size(); i++) {
+        A[i] = r.get_f(512) - 0.5;
+        B[i] = r.get_f(512) - 0.5;
+        A[i].mul_2exp(i % 5 * 20);
+        B[i].div_2exp(i % 3 * 30);
+        C[i] = mpf_class(0, 512);
+    }
+    mpf_class bound(1, 512);
+    bound.div_2exp(480);
+    for (int64_t threshold : {std::numeric_limits<int64_t>::max(), int64_t(1)}) {
+        blas::defaults::parallel_threshold = threshold;
+        std::vector<mpf_class> D(C), E(C);
+        blas::Rgemm("T", "N", m, n, k, alpha, A.data(), ld, B.data(), ld, beta, D.data(), ld);
+        blas::Rgemm_packed("T", "N", m, n, k, alpha, A.data(), ld, B.data(), ld, beta, E.data(), ld);
+        for (int64_t j = 0; j < n; j++)
+            for (int64_t i = 0; i < m; i++)
+                assert(abs(D[i + j * ld] - E[i + j * ld]) < bound * (abs(D[i + j * ld]) + 1));
+    }
+    blas::defaults::parallel_threshold = saved_threshold;
+    blas::defaults::l1_cache_bytes = saved_l1;
+    blas::defaults::l2_cache_bytes = saved_l2;
+    bool thrown = false;
+    try {
+        blas::Rgemm_packed("N", "N", m, n, k, alpha, A.data(), ld, B.data(), k - 1, beta, C.data(), ld);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "test_blas_packed passed." << std::endl;
+#endif
+}
+#if !defined USE_ORIGINAL_GMPXX && defined _OPENMP
+// threads that computed a leaf of Rgemm_strassen, as a bit mask; each leaf waits a millisecond so
+// that idle threads get to take the tasks
+static unsigned long strassen_leaf_threads = 0;
+static void record_strassen_leaf() {
+    unsigned long bit = 1UL << (omp_get_thread_num() % 64);
+#pragma omp atomic
+    strassen_leaf_threads |= bit;
+    double start = omp_get_wtime();
+    while (omp_get_wtime() - start < 1e-3) {
+    }
+}
+#endif
+void test_blas_strassen() {
+#if !defined USE_ORIGINAL_GMPXX
+    const int64_t saved_crossover = blas::defaults::strassen_crossover, saved_threshold = blas::defaults::parallel_threshold;
+    // a small crossover, so odd sizes are peeled at several levels
+    blas::defaults::strassen_crossover = 4;
+    const int64_t m = 23, n = 19, k = 37, ld = 41;
+    std::vector<mpf_class> A(ld * ld), B(ld * ld), C(ld * ld);
+    for (size_t i = 0; i < A.size(); i++) {
+        A[i] = static_cast<long>(i % 11) - 5;
+        B[i] = static_cast<long>(i % 7) - 3;
+        C[i] = static_cast<long>(i % 5) - 2;
+    }
+    mpf_class alpha(3), beta(-2);
+    for (int64_t threshold : {std::numeric_limits<int64_t>::max(), int64_t(1)}) {
+        blas::defaults::parallel_threshold = threshold;
+        for (const char *ta : {"N", "T"})
+            for (const char *tb : {"N", "C"})
+                for (const mpf_class &b : {beta, mpf_class(0), mpf_class(1)}) {
+                    std::vector<mpf_class> D(C), E(C);
+                    blas::Rgemm(ta, tb, m, n, k, alpha, A.data(), ld, B.data(), ld, b, D.data(), ld);
+                    blas::Rgemm_strassen(ta, tb, m, n, k, alpha, A.data(), ld, B.data(), ld, b, E.data(), ld);
+                    assert(D == E);
+                }
+    }
+
+    // random 512 bit operands against Rgemm; the guard bits keep the error at the last bits of C
+    gmp_randclass r(gmp_randinit_default);
+    r.seed(13);
+    for (size_t i = 0; i < A.size(); i++) {
+        A[i] = r.get_f(512) - 0.5;
+        B[i] = r.get_f(512) - 0.5;
+        C[i] = mpf_class(0, 512);
+    }
+    mpf_class bound(1, 512);
+    bound.div_2exp(500);
+    for (int64_t threshold : {std::numeric_limits<int64_t>::max(), int64_t(1)}) {
+        blas::defaults::parallel_threshold = threshold;
+        std::vector<mpf_class> D(C), E(C);
+        blas::Rgemm("N", "T", m, n, k, alpha, A.data(), ld, B.data(), ld, beta, D.data(), ld);
+        blas::Rgemm_strassen("N", "T", m, n, k, alpha, A.data(), ld, B.data(), ld, beta, E.data(), ld);
+        for (int64_t j = 0; j < n; j++)
+            for (int64_t i = 0; i < m; i++)
+                assert(abs(D[i + j * ld] - E[i + j * ld]) < bound);
+    }
+
+    // one limb powers of two from 2^-30 to 2^32, within the guard bits: every sum and product fits in
+    // 512 bits, so the recursion must not truncate them and both results are exact
+    for (size_t i = 0; i < A.size(); i++) {
+        A[i] = mpf_class(i % 3 == 0 ? -1 : 1, 512);
+        B[i] = mpf_class(i % 4 == 1 ? -1 : 1, 512);
+        A[i].mul_2exp(static_cast<mp_bitcnt_t>(i % 7 * 5));
+        A[i].div_2exp(30);
+        B[i].mul_2exp(static_cast<mp_bitcnt_t>(i % 5 * 8));
+        C[i] = mpf_class(0, 512);
+    }
+    for (int64_t threshold : {std::numeric_limits<int64_t>::max(), int64_t(1)}) {
+        blas::defaults::parallel_threshold = threshold;
+        std::vector<mpf_class> D(C), E(C);
+        blas::Rgemm("N", "N", m, n, k, alpha, A.data(), ld, B.data(), ld, beta, D.data(), ld);
+        blas::Rgemm_strassen("N", "N", m, n, k, alpha, A.data(), ld, B.data(), ld, beta, E.data(), ld);
+        assert(D == E);
+    }
+
+    // exponents spanning more than the accumulator window of Rgemm_packed and the guard bits of the
+    // recursion: 2^2000 next to 1, with zeros that make some of the huge products vanish
+    mpf_class huge(1, 512);
+    huge.mul_2exp(2000);
+    for (size_t i = 0; i < A.size(); i++) {
+        A[i] = i % 17 == 0 ? huge : mpf_class(static_cast<long>(i % 11) - 5, 512);
+        B[i] = mpf_class(i % 13 == 0 ? 0 : static_cast<long>(i % 7) - 3, 512);
+        C[i] = mpf_class(0, 512);
+    }
+    for (int64_t threshold : {std::numeric_limits<int64_t>::max(), int64_t(1)})
+        for (const char *ta : {"N", "T"}) {
+            blas::defaults::parallel_threshold = threshold;
+            std::vector<mpf_class> D(C), E(C);
+            blas::Rgemm(ta, "N", m, n, k, alpha, A.data(), ld, B.data(), ld, beta, D.data(), ld);
+            blas::Rgemm_strassen(ta, "N", m, n, k, alpha, A.data(), ld, B.data(), ld, beta, E.data(), ld);
+            assert(D == E);
+        }
+#if defined _OPENMP
+    // the products of the top levels are tasks that other threads of the team pick up
+    for (size_t i = 0; i < A.size(); i++) {
+        A[i] = static_cast<long>(i % 11) - 5;
+        B[i] = static_cast<long>(i % 7) - 3;
+    }
+    if (omp_get_max_threads() > 1) {
+        blas::defaults::parallel_threshold = 1;
+        blas::defaults::strassen_leaf_hook = record_strassen_leaf;
+        strassen_leaf_threads = 0;
+        std::vector<mpf_class> E(C);
+        blas::Rgemm_strassen("N", "N", m, n, k, alpha, A.data(), ld, B.data(), ld, beta, E.data(), ld);
+        blas::defaults::strassen_leaf_hook = nullptr;
+        assert((strassen_leaf_threads & (strassen_leaf_threads - 1)) != 0 && "Rgemm_strassen ran all leaves on one thread");
+    }
+#endif
+    blas::defaults::parallel_threshold = saved_threshold;
+    blas::defaults::strassen_crossover = saved_crossover;
+    bool thrown = false;
+    try {
+        blas::Rgemm_strassen("N", "N", m, n, k, alpha, A.data(), ld, B.data(), ld, beta, C.data(), m - 1);
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "test_blas_strassen passed." << std::endl;
+#endif
+}
+void test_omp_reductions() {
+#if !defined USE_ORIGINAL_GMPXX
+    // without OpenMP the loops run serially and must give the same results
+    const int n = 1000;
+    mpf_class fsum(0, 1024), fprod(1, 1024), fmin(0, 1024), fmax(0, 1024);
+    mpz_class zsum = 0, zprod = 1, zmin = 0, zmax = 0;
+    mpq_class qsum = 0, qmin = 0, qmax = 0;
+#if defined _OPENMP
+#pragma omp parallel for reduction(+ : fsum, zsum, qsum) reduction(min : fmin, zmin, qmin) reduction(max : fmax, zmax, qmax)
+#endif
+    for (int i = 1; i <= n; i++) {
+        mpf_class x(i, 1024);
+        x /= 3;
+        fsum += x;
+        zsum += i * i;
+        qsum += mpq_class(1, i);
+        int v = (i * 37) % 101 - 50;
+        if (mpf_class(v) < fmin)
+            fmin = v;
+        if (mpf_class(v) > fmax)
+            fmax = v;
+        zmin = std::min(zmin, mpz_class(v));
+        zmax = std::max(zmax, mpz_class(v));
+        if (mpq_class(v, 7) < qmin)
+            qmin = mpq_class(v, 7);
+        if (mpq_class(v, 7) > qmax)
+            qmax = mpq_class(v, 7);
+    }
+#if defined _OPENMP
+#pragma omp parallel for reduction(* : fprod, zprod)
+#endif
+    for (int i = 1; i <= 30; i++) {
+        fprod *= mpf_class(i, 1024);
+        zprod *= i;
+    }
+    // the private copies keep the precision of fsum, so the sum is exact to about 1024 bits
+    mpf_class expected(n * (n + 1) / 2, 1024), bound(1, 1024);
+    expected /= 3;
+    bound.div_2exp(1000);
+    assert(fsum.get_prec() == 1024 && abs(fsum - expected) < bound);
+    assert(zsum == mpz_class(n) * (n + 1) * (2 * n + 1) / 6);
+    mpq_class harmonic = 0;
+    for (int i = 1; i <= n; i++)
+        harmonic += mpq_class(1, i);
+    assert(qsum == harmonic);
+    mpz_class factorial;
+    mpz_fac_ui(factorial.get_mpz_t(), 30);
+    assert(zprod == factorial && fprod == mpf_class(factorial.get_mpz_t(), 1024));
+    assert(fmin == -50 && fmax == 50 && zmin == -50 && zmax == 50 && qmin == mpq_class(-50, 7) && qmax == mpq_class(50, 7));
+    std::cout << "test_omp_reductions passed." << std::endl;
+#endif
+}
 void testInitializationAndAssignmentDouble() {
     double testValue = 3.1415926535;
     const char *expectedValue = "3.1415926535";
@@ -1180,7 +1992,7 @@ void testMathFunctions_mpz_class() {
 }
 template <class T> T test_func(const T &a, const T &b) { return a * b; }
 void test_mpf_class_extention() {
-#if !defined USE_ORIGINAL_GMPXX
+#if !defined USE_ORIGINAL_GMPXX && !defined ___GMPXX_MKII_EXPRESSION_TEMPLATES___ // f * h is an expression, not an mpf_class, in the expression template mode
     mpf_class f(2), g(1), h(3);
 
     mpf_class result;
@@ -2281,6 +3093,153 @@ void test_mpf_class_const_log2() {
     std::cout << "test_mpf_class_const_log2 passed." << std::endl;
 #endif
 }
+void test_mpf_class_const_e() {
+#if !defined USE_ORIGINAL_GMPXX
+    // https://www.wolframalpha.com/input?i=N%5BE%2C+1000%5D
+    const char *e_approx = "2.7182818284590452353602874713526624977572470936999595749669676277240766303535475945713821785251664274274663919320030599218174135966290435729003342952605956307381323286279434907632338298807531952510190115738341879307021540891499348841675092447614606680822648001684774118537423454424371075390777449920695517027618386062613313845830007520449338265602976067371132007093287091274437470472306969772093101416928368190255151086574637721112523897844250569536967707854499699679468644549059879316368892300987931277361782154249992295763514822082698951936680331825288693984964651058209392398294887933203625094431173012381970684161403970198376793206832823764648042953118023287825098194558153017567173613320698112509961818815930416903515988885193458072738667385894228792284998920868058257492796104841984443634632449684875602336248270419786232090021609902353043699418491463140934317381436405462531520961836908887070167683964243781405927145635490613031072085103837505101157477041718986106873969655212671546889570350354";
+    mp_bitcnt_t prec = mpf_get_default_prec();
+    int decimal_digits = floor(std::log10(2) * prec);
+    mp_exp_t exp;
+    for (int trial = 0; trial < 2; trial++) { // the 2nd value is cached
+        mpf_class calculated_e = const_e();
+        std::string _calculated_e_str = calculated_e.get_str(exp, 10, decimal_digits);
+        std::string calculated_e_str = insertDecimalPoint(_calculated_e_str, exp);
+        int i;
+        for (i = 0; i < decimal_digits; ++i) {
+            if (e_approx[i] != calculated_e_str[i]) {
+                break;
+            }
+        }
+        std::cout << "e matched in " << i - 1 << " decimal digits" << std::endl;
+        assert(i - 1 > decimal_digits - 2 && "not accurate");
+    }
+#if !defined ___GMPXX_MKII_NOPRECCHANGE___
+    mpf_class e_2048 = const_e(2048);
+    assert(e_2048.get_prec() == 2048);
+    decimal_digits = floor(std::log10(2) * 2048);
+    std::string calculated_e_str = insertDecimalPoint(e_2048.get_str(exp, 10, decimal_digits), exp);
+    int i;
+    for (i = 0; i < decimal_digits; ++i) {
+        if (e_approx[i] != calculated_e_str[i]) {
+            break;
+        }
+    }
+    std::cout << "e matched in " << i - 1 << " decimal digits (2048 bits)" << std::endl;
+    assert(i - 1 > decimal_digits - 2 && "not accurate");
+#endif
+    std::cout << "test_mpf_class_const_e passed." << std::endl;
+#endif
+}
+void test_mpf_class_const_log10() {
+#if !defined USE_ORIGINAL_GMPXX
+    // https://www.wolframalpha.com/input?i=N%5Bln%2810%29%2C+1000%5D
+    const char *log10_approx = "2.3025850929940456840179914546843642076011014886287729760333279009675726096773524802359972050895982983419677840422862486334095254650828067566662873690987816894829072083255546808437998948262331985283935053089653777326288461633662222876982198867465436674744042432743651550489343149393914796194044002221051017141748003688084012647080685567743216228355220114804663715659121373450747856947683463616792101806445070648000277502684916746550586856935673420670581136429224554405758925724208241314695689016758940256776311356919292033376587141660230105703089634572075440370847469940168269282808481184289314848524948644871927809676271275775397027668605952496716674183485704422507197965004714951050492214776567636938662976979522110718264549734772662425709429322582798502585509785265383207606726317164309505995087807523710333101197857547331541421808427543863591778117054309827482385045648019095610299291824318237525357709750539565187697510374970888692180205189339507238539205144634197265287286965110862571492198849978";
+    mp_bitcnt_t prec = mpf_get_default_prec();
+    int decimal_digits = floor(std::log10(2) * prec);
+    mp_exp_t exp;
+    for (int trial = 0; trial < 2; trial++) { // the 2nd value is cached
+        mpf_class calculated_log10 = const_log10();
+        std::string _calculated_log10_str = calculated_log10.get_str(exp, 10, decimal_digits);
+        std::string calculated_log10_str = insertDecimalPoint(_calculated_log10_str, exp);
+        int i;
+        for (i = 0; i < decimal_digits; ++i) {
+            if (log10_approx[i] != calculated_log10_str[i]) {
+                break;
+            }
+        }
+        std::cout << "log10 matched in " << i - 1 << " decimal digits" << std::endl;
+        assert(i - 1 > decimal_digits - 3 && "not accurate");
+    }
+#if !defined ___GMPXX_MKII_NOPRECCHANGE___
+    mpf_class log10_2048 = const_log10(2048);
+    assert(log10_2048.get_prec() == 2048);
+    decimal_digits = floor(std::log10(2) * 2048);
+    std::string calculated_log10_str = insertDecimalPoint(log10_2048.get_str(exp, 10, decimal_digits), exp);
+    int i;
+    for (i = 0; i < decimal_digits; ++i) {
+        if (log10_approx[i] != calculated_log10_str[i]) {
+            break;
+        }
+    }
+    std::cout << "log10 matched in " << i - 1 << " decimal digits (2048 bits)" << std::endl;
+    assert(i - 1 > decimal_digits - 2 && "not accurate");
+#endif
+    std::cout << "test_mpf_class_const_log10 passed." << std::endl;
+#endif
+}
+void test_mpf_class_constant_cache() {
+#if !defined USE_ORIGINAL_GMPXX && !defined ___GMPXX_MKII_NOPRECCHANGE___
+    mpf_class::reset_pi_cache();
+    mpf_class::reset_log2_cache();
+    mpf_class epsilon(1.0, 512);
+    epsilon.div_2exp(510);
+
+    // a higher precision value is reused by rounding down
+    mpf_class pi_1024 = const_pi(1024);
+    mpf_class pi_512 = const_pi(512);
+    assert(pi_1024.get_prec() == 1024);
+    assert(pi_512.get_prec() == 512);
+    assert(abs(pi_512 - const_pi_AGM(512)) < epsilon && "cached pi is not accurate");
+
+    mpf_class log2_1024 = const_log2(1024);
+    mpf_class log2_512 = const_log2(512);
+    assert(log2_512.get_prec() == 512);
+    assert(abs(log2_512 - const_log2_AGM(512)) < epsilon && "cached log2 is not accurate");
+
+    // the second call returns the same value
+    assert(const_pi(1024) == pi_1024);
+    assert(const_log2(1024) == log2_1024);
+
+    mpf_class e_1024 = const_e(1024);
+    assert(const_e(512).get_prec() == 512);
+    assert(const_e(1024) == e_1024);
+    mpf_class log10_1024 = const_log10(1024);
+    assert(const_log10(1024) == log10_1024);
+
+    mpf_class::reset_pi_cache();
+    mpf_class::reset_e_cache();
+    mpf_class::reset_log10_cache();
+    mpf_class::reset_log2_cache();
+    assert(abs(const_pi(512) - pi_512) < epsilon);
+    assert(abs(const_e(1024) - e_1024) < epsilon);
+    assert(abs(const_log10(1024) - log10_1024) < epsilon);
+    assert(abs(const_log2(512) - log2_512) < epsilon);
+
+    // the value is computed outside the lock, so the computation may use the cache itself
+    mpf_constant_cache cache;
+    mpf_class nested = cache.get(1024, [&cache](mp_bitcnt_t prec) { return cache.get(prec, const_pi_AGM); });
+    assert(nested == const_pi_AGM(1024) && cache.get(512, const_pi_AGM) == mpf_class(nested, 512));
+    std::cout << "test_mpf_class_constant_cache passed." << std::endl;
+#endif
+}
+void test_mpf_class_const_pi_chudnovsky() {
+#if !defined USE_ORIGINAL_GMPXX
+    mp_bitcnt_t prec = mpf_get_default_prec();
+    mpf_class epsilon(1.0, prec);
+    epsilon.div_2exp(prec - 2);
+    assert(abs(const_pi_chudnovsky(prec) - const_pi_AGM(prec)) < epsilon && "Chudnovsky pi is not accurate");
+
+    // select the backend of const_pi()
+    gmpxx_defaults::pi_algorithm = const_pi_algorithm::chudnovsky;
+    mpf_class::reset_pi_cache();
+    mpf_class pi = const_pi();
+    assert(pi.get_prec() == prec);
+    assert(abs(pi - const_pi_AGM(prec)) < epsilon && "const_pi() with Chudnovsky backend is not accurate");
+    // each backend has its own cache, so switching back needs no reset
+    gmpxx_defaults::pi_algorithm = const_pi_algorithm::AGM;
+    assert(const_pi() == const_pi_AGM(prec));
+    gmpxx_defaults::pi_algorithm = const_pi_algorithm::chudnovsky;
+    assert(const_pi() == pi);
+    gmpxx_defaults::pi_algorithm = const_pi_algorithm::AGM;
+    mpf_class::reset_pi_cache();
+#if !defined ___GMPXX_MKII_NOPRECCHANGE___
+    mpf_class epsilon_8192(1.0, 8192);
+    epsilon_8192.div_2exp(8190);
+    assert(abs(const_pi_chudnovsky(8192) - const_pi_AGM(8192)) < epsilon_8192 && "Chudnovsky pi is not accurate");
+#endif
+    std::cout << "test_mpf_class_const_pi_chudnovsky passed." << std::endl;
+#endif
+}
 void test_div2exp_mul2exp_mpf_class(void) {
 #if !defined USE_ORIGINAL_GMPXX
     mpf_class value(2.0);
@@ -2451,6 +3410,40 @@ void test_exp_mpf_class(void) {
     }
     std::cout << "expm10 matched in " << i - 1 << " decimal digits" << std::endl;
     assert(i - 1 > decimal_digits - 4 && "not accurate");
+#if !defined ___GMPXX_MKII_NOPRECCHANGE___
+    // bit-burst kernel at higher precision
+    mpf_class epsilon_8192(1.0, 8192);
+    epsilon_8192.div_2exp(8190);
+    mpf_class one_8192(1.0, 8192);
+    mpf_class exp1_8192 = exp(one_8192);
+    assert(exp1_8192.get_prec() == 8192);
+    assert(abs(exp1_8192 - const_e(8192)) < epsilon_8192 && "exp(1) is not accurate");
+    mpf_class x_8192("-123.456", 8192);
+    mpf_class exp_x = exp(x_8192), exp_minus_x = exp(-x_8192);
+    assert(abs(exp_x * exp_minus_x - one_8192) < epsilon_8192 && "exp(x) exp(-x) is not 1");
+    mpf_class exp_half_x = exp(x_8192 / 2);
+    assert(abs(exp_half_x * exp_half_x / exp_x - one_8192) < 4 * epsilon_8192 && "exp(x/2)^2 is not exp(x)");
+#endif
+    // the reduction keeps guard bits in both modes
+    mpf_class epsilon(1.0), one(1.0);
+    epsilon.div_2exp(prec - 2);
+    x = mpf_class("-123.456");
+    assert(abs(exp(x) * exp(-x) - one) < epsilon && "exp(x) exp(-x) is not 1");
+    // x / log2 does not fit in a long, but the result is still representable
+    mpf_class huge(1.0);
+    huge.mul_2exp(66);
+    mpf_class exp_huge = exp(huge), exp_half_huge = exp(huge / 2);
+    assert(abs(exp(huge) * exp(-huge) - one) < epsilon && "exp(2^66) exp(-2^66) is not 1");
+    assert(abs(exp_half_huge * exp_half_huge / exp_huge - one) < 4 * epsilon && "exp(2^65)^2 is not exp(2^66)");
+    huge.mul_2exp(8);
+    assert(exp(-huge) == 0 && "exp(-2^74) does not underflow to 0");
+    bool overflow = false;
+    try {
+        exp(huge);
+    } catch (const std::overflow_error &) {
+        overflow = true;
+    }
+    assert(overflow && "exp(2^74) does not throw overflow_error");
     std::cout << "test_exp_mpf_class passed." << std::endl;
 #endif
 }
@@ -2750,6 +3743,52 @@ void test_reminder() {
 #endif
 }
 
+void test_hypergeometric_sum() {
+#if !defined USE_ORIGINAL_GMPXX
+    mp_bitcnt_t prec = mpf_get_default_prec();
+    mpf_class epsilon(1.0, prec);
+    epsilon.div_2exp(prec - 4);
+    auto one = [](unsigned long, mpz_class &r) { r = 1; };
+    auto n_or_one = [](unsigned long n, mpz_class &r) { r = (n == 0 ? 1UL : n); };
+    // \sum 1/n! = e and \sum n/n! = e
+    auto n = [](unsigned long n, mpz_class &r) { r = n; };
+    assert(abs(hypergeometric_sum(prec, one, one, n_or_one, prec) - const_e()) < epsilon && "sum 1/n! is not e");
+    assert(abs(hypergeometric_sum(prec, n, one, n_or_one, prec) - const_e()) < epsilon && "sum n/n! is not e");
+    // (1 - x)^(-1/2) = \sum binomial(2n, n) (x/4)^n at x = 1/2 is sqrt(2)
+    auto p = [](unsigned long n, mpz_class &r) { r = (n == 0 ? 1UL : 2 * n - 1); };
+    auto q = [](unsigned long n, mpz_class &r) { r = (n == 0 ? 1UL : 4 * n); };
+    mpf_class sqrt2 = hypergeometric_sum(prec + 8, one, p, q, prec);
+    assert(sqrt2.get_prec() == prec);
+    assert(abs(sqrt2 - sqrt(mpf_class(2.0, prec))) < epsilon && "binomial series is not sqrt(2)");
+    // many terms go through the parallel split
+    mpf_class e_large = hypergeometric_sum(4096, one, one, n_or_one, prec);
+    assert(abs(e_large - const_e()) < epsilon);
+    std::cout << "test_hypergeometric_sum passed." << std::endl;
+#endif
+}
+void test_paterson_stockmeyer() {
+#if !defined USE_ORIGINAL_GMPXX
+    mp_bitcnt_t prec = mpf_get_default_prec();
+    mpf_class epsilon(1.0, prec);
+    epsilon.div_2exp(prec - 4);
+    mpf_class one(1.0, prec);
+    // e = \sum 1/j!
+    assert(abs(paterson_stockmeyer(one, [](unsigned long j) { return j; }) - const_e()) < epsilon && "sum 1/j! is not e");
+    // cos(1) = \sum (-1)^j / (2j)!, cosh(1) = \sum 1 / (2j)!
+    mpf_class minus_one(-1.0, prec);
+    mpf_class cos1 = paterson_stockmeyer(minus_one, [](unsigned long j) { return (2 * j - 1) * (2 * j); });
+    mpf_class cosh1 = paterson_stockmeyer(one, [](unsigned long j) { return (2 * j - 1) * (2 * j); });
+    assert(abs(cos1 - cos(one)) < epsilon && "sum (-1)^j / (2j)! is not cos(1)");
+    assert(abs(cosh1 - (const_e() + one / const_e()) / 2) < epsilon && "sum 1 / (2j)! is not cosh(1)");
+    // large arguments: the truncation is relative to the largest term
+    mpf_class ten(10.0, prec);
+    assert(abs(paterson_stockmeyer(ten, [](unsigned long j) { return j; }) / exp(ten) - one) < 16 * epsilon && "sum 10^j/j! is not exp(10)");
+    // exp_taylor uses the same evaluator
+    mpf_class x("0.3", prec);
+    assert(abs(exp_taylor(x) - exp(x)) < epsilon && "exp_taylor is not accurate");
+    std::cout << "test_paterson_stockmeyer passed." << std::endl;
+#endif
+}
 void test_cos() {
 #if !defined USE_ORIGINAL_GMPXX
 #ifdef NOT_COMPILE
@@ -2924,6 +3963,32 @@ void test_tan() {
     std::cout << "test_tan passed." << std::endl;
 #endif
 }
+void test_sincos() {
+#if !defined USE_ORIGINAL_GMPXX
+    mp_bitcnt_t prec = mpf_get_default_prec();
+    mpf_class epsilon(1.0, prec);
+    epsilon.div_2exp(prec - 8);
+    mpf_class one(1.0, prec);
+    // all quadrants, both signs and beyond 2pi
+    const char *args[] = {"0", "0.5", "1.0", "2.0", "3.0", "4.0", "5.0", "6.0", "-0.5", "-2.5", "-4.5", "10.0", "100.25"};
+    for (const char *arg : args) {
+        mpf_class x(arg, prec), sinx, cosx;
+        sincos(x, sinx, cosx);
+        assert(abs(sinx - sin(x)) < epsilon && "sincos: sin is not accurate");
+        assert(abs(cosx - cos(x)) < epsilon && "sincos: cos is not accurate");
+        assert(abs(sinx * sinx + cosx * cosx - one) < epsilon && "sincos: sin^2 + cos^2 != 1");
+    }
+    // small arguments keep their relative accuracy in both modes: sin(x) = x - x^3/6 + x^5/120 - O(x^7)
+    mpf_class x("1e-30", prec), sinx, cosx;
+    sincos(x, sinx, cosx);
+    mpf_class x2(x * x);
+    mpf_class series(x * (one - x2 / 6 + x2 * x2 / 120));
+    assert(abs((sinx - series) / x) < epsilon && "sincos: sin(x) of small x is not accurate");
+    // tan() is sin/cos from sincos()
+    assert(abs(tan(mpf_class(1.0)) - sin(mpf_class(1.0)) / cos(mpf_class(1.0))) < epsilon);
+    std::cout << "test_sincos passed." << std::endl;
+#endif
+}
 void test_pow() {
 #if !defined USE_ORIGINAL_GMPXX
     mpf_class x, y;
@@ -3164,6 +4229,125 @@ void test_atan2() {
     std::cout << "test_atan2 passed." << std::endl;
 #endif
 }
+void test_asin_acos() {
+#if !defined USE_ORIGINAL_GMPXX
+    mp_bitcnt_t prec = mpf_get_default_prec();
+    mpf_class epsilon(1.0, prec);
+    epsilon.div_2exp(prec - 8);
+    mpf_class pi = const_pi();
+    mpf_class half(0.5, prec), one(1.0, prec);
+    // atan(1) = pi/4, asin(1/2) = pi/6, acos(1/2) = pi/3, acos(-1/2) = 2pi/3
+    assert(abs(atan(one) - pi / 4) < epsilon && "atan(1) is not pi/4");
+    assert(abs(asin(half) - pi / 6) < epsilon && "asin(1/2) is not pi/6");
+    assert(abs(acos(half) - pi / 3) < epsilon && "acos(1/2) is not pi/3");
+    assert(abs(acos(-half) - 2 * pi / 3) < epsilon && "acos(-1/2) is not 2pi/3");
+    assert(abs(atan2(-one, -one) + 3 * pi / 4) < epsilon && "atan2(-1, -1) is not -3pi/4");
+    const char *args[] = {"-0.99", "-0.3", "0.001", "0.7", "0.999"};
+    for (const char *arg : args) {
+        mpf_class x(arg, prec);
+        assert(abs(sin(asin(x)) - x) < epsilon && "sin(asin(x)) is not x");
+        assert(abs(tan(atan(x)) - x) < epsilon && "tan(atan(x)) is not x");
+    }
+    std::cout << "test_asin_acos passed." << std::endl;
+#endif
+}
+void test_sinh_cosh_tanh() {
+#if !defined USE_ORIGINAL_GMPXX
+    mp_bitcnt_t prec = mpf_get_default_prec();
+    mpf_class epsilon(1.0, prec);
+    epsilon.div_2exp(prec - 8);
+    mpf_class one(1.0, prec);
+    mpf_class e = const_e();
+    // sinh(1) = (e - 1/e) / 2, cosh(1) = (e + 1/e) / 2
+    assert(abs(sinh(one) - (e - one / e) / 2) < epsilon && "sinh(1) is not accurate");
+    assert(abs(cosh(one) - (e + one / e) / 2) < epsilon && "cosh(1) is not accurate");
+    assert(abs(tanh(one) - (e * e - one) / (e * e + one)) < epsilon && "tanh(1) is not accurate");
+    const char *args[] = {"-3.5", "-0.4", "0", "1e-3", "0.49", "0.5", "2.0", "20.0"};
+    for (const char *arg : args) {
+        mpf_class x(arg, prec), sinh_x, cosh_x;
+        sinhcosh(x, sinh_x, cosh_x);
+        assert(abs(sinh_x - sinh(x)) <= epsilon * abs(sinh_x) && "sinhcosh: sinh is not accurate");
+        assert(abs(cosh_x - cosh(x)) <= epsilon * cosh_x && "sinhcosh: cosh is not accurate");
+        assert(abs((cosh_x - sinh_x) * (cosh_x + sinh_x) - one) < epsilon * cosh_x * cosh_x && "cosh^2 - sinh^2 != 1");
+        assert(abs(tanh(x) - sinh_x / cosh_x) < epsilon && "tanh is not sinh / cosh");
+    }
+    // small arguments keep their relative accuracy: sinh(x) = x + x^3/6 + x^5/120 + O(x^7)
+    mpf_class x("1e-40", prec);
+    mpf_class x2(x * x);
+    mpf_class series(x * (one + x2 / 6 + x2 * x2 / 120));
+    assert(abs((sinh(x) - series) / x) < epsilon && "sinh(x) of small x is not accurate");
+    assert(abs((tanh(x) - x * (one - x2 / 3)) / x) < epsilon && "tanh(x) of small x is not accurate");
+    std::cout << "test_sinh_cosh_tanh passed." << std::endl;
+#endif
+}
+void test_ziv_evaluate() {
+#if !defined USE_ORIGINAL_GMPXX && !defined ___GMPXX_MKII_NOPRECCHANGE___
+    mp_bitcnt_t prec = mpf_get_default_prec();
+    mpf_class one(1.0, prec);
+    unsigned int retries = 0;
+    // the result is within half an ulp of a higher precision reference
+    mpf_class e = ziv_evaluate(one, exp_bit_burst, &retries);
+    mpf_class e_ref = const_e(prec + 256);
+    mpf_class half_ulp(1.0, prec);
+    half_ulp.div_2exp(prec - 1); // e < 4
+    assert(e.get_prec() == prec);
+    assert(abs(mpf_class(e, prec + 256) - e_ref) <= half_ulp && "ziv_evaluate: exp(1) is not rounded to nearest");
+    // exact results are accepted without retries
+    mpf_class zero(0.0, prec);
+    assert(ziv_evaluate(zero, exp_bit_burst, &retries) == 1 && retries == 0);
+    // an error bound larger than the guard bits forces retries
+    ziv_statistics stats_before = ziv_stats;
+    mp_bitcnt_t guard_bits = gmpxx_defaults::ziv_guard_bits;
+    mp_bitcnt_t error_bits = gmpxx_defaults::ziv_error_bits;
+    gmpxx_defaults::ziv_guard_bits = 1;
+    gmpxx_defaults::ziv_error_bits = 100;
+    mpf_class x("0.75", prec);
+    mpf_class log_x = ziv_evaluate(x, log_AGM, &retries);
+    gmpxx_defaults::ziv_guard_bits = guard_bits;
+    gmpxx_defaults::ziv_error_bits = error_bits;
+    assert(retries > 0 && "ziv_evaluate did not retry");
+    assert(ziv_stats.evaluations == stats_before.evaluations + 1);
+    assert(ziv_stats.retries == stats_before.retries + retries);
+    mpf_class log_ref = log_AGM(mpf_class(x, prec + 256));
+    assert(abs(mpf_class(log_x, prec + 256) - log_ref) <= half_ulp && "ziv_evaluate: log(0.75) is not accurate");
+    std::cout << "ziv_evaluate: " << retries << " retries for log(0.75)" << std::endl;
+    std::cout << "test_ziv_evaluate passed." << std::endl;
+#endif
+}
+void test_mpf_fixed() {
+#if !defined USE_ORIGINAL_GMPXX
+    typedef mpf_fixed<512> fixed;
+    assert(fixed().get_prec() == mpf_class(0.0, 512).get_prec());
+    fixed v[4] = {1.5, 2, -3L, fixed("0.25")};
+    static_assert(sizeof(v) == 4 * sizeof(fixed), "mpf_fixed arrays must be contiguous");
+    fixed s;
+    for (int i = 0; i < 4; i++)
+        s += v[i] * v[i];
+    assert(s == fixed(15.3125));
+    assert(v[0] + v[1] == fixed(3.5) && v[0] - v[1] == fixed(-0.5) && v[1] / v[3] == fixed(8) && -v[2] == fixed(3));
+    assert(abs(v[2]) > v[1] && sqrt(fixed(16)) == fixed(4));
+    // copies and moves keep their own limbs
+    fixed w(v[3]);
+    fixed u(std::move(w));
+    v[3] = 7;
+    assert(u == fixed(0.25) && v[3] == fixed(7));
+    std::vector<fixed> vec(100, fixed(1));
+    vec.push_back(fixed(2));
+    assert(vec[0] == fixed(1) && vec[100] == fixed(2));
+    // interoperation with mpf_class
+    mpf_class third(1.0, 512);
+    third /= 3;
+    fixed f(third);
+    mpf_class g = f;
+    assert(g == third && g.get_prec() == 512);
+    mpf_mul_ui(f.get_mpf_t(), f.get_mpf_t(), 3);
+    assert(abs(mpf_class(f) - 1) < mpf_class(1e-150));
+    std::stringstream ss;
+    ss << fixed(1.25);
+    assert(ss.str() == "1.25");
+    std::cout << "test_mpf_fixed passed." << std::endl;
+#endif
+}
 int main() {
 #if defined USE_ORIGINAL_GMPXX
     mpf_set_default_prec(512);
@@ -3210,6 +4394,20 @@ int main() {
     test_fits_ulong_p();
     test_fits_ushort_p();
     testAssignmentOperator_the_rule_of_five();
+    test_mpf_class_moved_from();
+    test_rvalue_operators();
+    test_expression_templates();
+    test_fused_multiply_add();
+    test_pool_allocator();
+    test_scratch_scope();
+    test_mpf_vector_matrix();
+    test_move_assign_policy();
+    test_mpz_small();
+    test_blas();
+    test_mpf_exact_accumulator();
+    test_blas_packed();
+    test_blas_strassen();
+    test_omp_reductions();
     test_mpf_class_extention();
 
     // mpz_class
@@ -3257,6 +4455,10 @@ int main() {
     // mpf_class transcendental functions
     test_mpf_class_const_pi();
     test_mpf_class_const_log2();
+    test_mpf_class_const_e();
+    test_mpf_class_const_log10();
+    test_mpf_class_constant_cache();
+    test_mpf_class_const_pi_chudnovsky();
     test_div2exp_mul2exp_mpf_class();
     test_log_mpf_class();
     test_exp_mpf_class();
@@ -3270,14 +4472,21 @@ int main() {
 
     //
     test_reminder();
+    test_hypergeometric_sum();
+    test_paterson_stockmeyer();
     test_cos();
     test_sin();
     test_tan();
+    test_sincos();
     test_pow();
     test_log2();
     test_log10();
     test_atan();
     test_atan2();
+    test_asin_acos();
+    test_sinh_cosh_tanh();
+    test_ziv_evaluate();
+    test_mpf_fixed();
     std::cout << "All tests passed." << std::endl;
 
     return 0;